@@ -1,64 +1,337 @@
 #ifndef VOC_ANY_H
 #define VOC_ANY_H
 
+#include <cstddef>
 #include <typeinfo>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 
+#include "Optional.h"
+
+#ifndef VOC_HAS_RTTI
+#if defined(__GXX_RTTI) || defined(_CPPRTTI) || defined(__cpp_rtti)
+#define VOC_HAS_RTTI 1 // typeid and std::type_info are available
+#else
+#define VOC_HAS_RTTI 0 // built with -fno-rtti, types are identified with TypeId only
+#endif
+#endif
+
+#ifndef VOC_ENABLE_STATS
+#define VOC_ENABLE_STATS 0 // count the allocations, copies, moves and casts of Any, see AnyStats.h
+#endif
+
 namespace voc
 {
+  /// @brief Identifier of a type, that does not need RTTI
+  using TypeId = const void *;
+
   namespace details
   {
-    /// @brief Base class for AnyConcrete
-    class AnyBase
+    /// @brief Tag whose address identifies the type T
+    template <typename T>
+    struct TypeIdTag
     {
-    public:
-      /// @brief Default destructor
-      virtual ~AnyBase() = default;
+      static constexpr char id = 0; ///< The variable whose address is the identifier
+    };
+  }
+
+  /// @brief Get the identifier of a type
+  /// @tparam T The type
+  /// @return The identifier of T, unique for each type
+  template <typename T>
+  constexpr TypeId typeId() noexcept
+  {
+    return &details::TypeIdTag<std::remove_cv_t<T>>::id;
+  }
+
+  namespace details
+  {
+#if VOC_ENABLE_STATS
+    // Counters of AnyStats.h, added to the shard of the calling thread
+
+#if VOC_HAS_RTTI
+    /// @brief Count a value created in an Any object
+    void countAnyValue(TypeId id, const std::type_info *type) noexcept;
+#else
+    /// @brief Count a value created in an Any object
+    void countAnyValue(TypeId id) noexcept;
+#endif
 
-      /// @brief Clone the current object
-      /// @return A unique_ptr to the cloned object
-      virtual std::unique_ptr<AnyBase> clone() const = 0;
+    /// @brief Count a heap allocation of bytes for a value
+    void countAnyAllocation(std::size_t bytes) noexcept;
 
-      /// @brief Get the type of the stored value
-      /// @return The type_info of the stored value
-      virtual const std::type_info &type() const = 0;
+    /// @brief Count a copy of a value
+    void countAnyClone() noexcept;
+
+    /// @brief Count a move of a value
+    void countAnyMove() noexcept;
+
+    /// @brief Count a cast, successful or not
+    void countAnyCast(bool hit) noexcept;
+#endif
+
+    /// @brief Size in bytes of the inline buffer of Any
+    inline constexpr std::size_t AnyInlineSize = 3 * sizeof(void *);
+
+    /// @brief Alignment of the inline buffer of Any
+    inline constexpr std::size_t AnyInlineAlign = alignof(void *);
+
+    /// @brief Storage of Any, either the value itself or a pointer to the value on the heap
+    union AnyStorage
+    {
+      void *ptr; ///< The value on the heap
+      alignas(AnyInlineAlign) unsigned char buffer[AnyInlineSize]; ///< The value stored inline
     };
 
-    /// @brief Concrete class to store any type of value
+    /// @brief Whether a value of type T is stored in the inline buffer of Any
     template <typename T>
-    class AnyConcrete : public AnyBase
+    inline constexpr bool AnyFitsInline = sizeof(T) <= AnyInlineSize && alignof(T) <= AnyInlineAlign && std::is_nothrow_move_constructible<T>::value;
+
+    /// @brief Table of the operations on a type stored in Any
+    ///
+    /// There is one constant table per stored type, so an Any only needs a pointer to it.
+    /// @tparam Allocator The allocator used for the values stored on the heap
+    template <typename Allocator>
+    struct AnyManager
     {
-    public:
-      /// @brief Constructor from a value
-      /// @param value The value to be stored
-      template <typename U>
-      AnyConcrete(U &&value) : value(std::forward<U>(value)) {}
+      /// @brief Destroy the value and release its storage
+      void (*destroy)(AnyStorage &storage, Allocator &alloc) noexcept;
+
+      /// @brief Copy the value of src in dst, dst must be empty, nullptr for move-only types
+      void (*copy)(const AnyStorage &src, AnyStorage &dst, Allocator &alloc);
+
+      /// @brief Transfer the value of src in dst, dst must be empty and src is left empty
+      ///
+      /// The value must have been allocated with an allocator equal to the one of dst.
+      void (*move)(AnyStorage &src, AnyStorage &dst) noexcept;
+
+      /// @brief Transfer the value of src in dst, allocated with different allocators
+      void (*relocate)(AnyStorage &src, Allocator &srcAlloc, AnyStorage &dst, Allocator &dstAlloc);
+
+      /// @brief The identifier of the stored type
+      TypeId typeId;
+
+#if VOC_HAS_RTTI
+      /// @brief The type_info of the stored value
+      const std::type_info *type;
+#endif
+
+      /// @brief Whether the value is stored in the inline buffer or on the heap
+      bool isInline;
+    };
+
+    /// @brief Implementation of the operations of AnyManager for a type T
+    template <typename T, typename Allocator>
+    struct AnyHandler
+    {
+      /// @brief The allocator traits for T
+      using Traits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
 
-      /// @brief Clone the current object
-      /// @return A unique_ptr to the cloned object
-      std::unique_ptr<AnyBase> clone() const override
+      /// @brief Check if the value is stored in the inline buffer of Any or on the heap
+      /// @return true if the value fits in the inline buffer and can be moved without throwing
+      static constexpr bool isInline()
       {
-        return std::make_unique<AnyConcrete<T>>(*this);
+        return AnyFitsInline<T>;
       }
 
-      /// @brief Get the stored value
-      /// @return The stored value
-      const T &getValue() const
+      /// @brief Create a new value in the storage
+      /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+      /// @param storage The storage, must be empty
+      /// @param alloc The allocator used if the value is stored on the heap
+      /// @param ...args The arguments to be passed to the constructor of T
+      template <typename... Args>
+      static void create(AnyStorage &storage, Allocator &alloc, Args &&...args)
+      {
+#if VOC_ENABLE_STATS
+#if VOC_HAS_RTTI
+        countAnyValue(voc::typeId<T>(), &typeid(T));
+#else
+        countAnyValue(voc::typeId<T>());
+#endif
+        if constexpr (!isInline())
+        {
+          countAnyAllocation(sizeof(T));
+        }
+#endif
+        if constexpr (isInline())
+        {
+          (void)alloc;
+          new (storage.buffer) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+          typename Traits::allocator_type valueAlloc(alloc);
+          T *ptr = std::addressof(*Traits::allocate(valueAlloc, 1));
+          try
+          {
+            new (ptr) T(std::forward<Args>(args)...);
+          }
+          catch (...)
+          {
+            Traits::deallocate(valueAlloc, ptr, 1);
+            throw;
+          }
+          storage.ptr = ptr;
+        }
+      }
+
+      /// @brief Get a pointer to the stored value
+      /// @param storage The storage
+      /// @return A pointer to the stored value
+      static T *get(AnyStorage &storage) noexcept
+      {
+        if constexpr (isInline())
+        {
+          return std::launder(reinterpret_cast<T *>(storage.buffer));
+        }
+        else
+        {
+          return static_cast<T *>(storage.ptr);
+        }
+      }
+
+      /// @brief Get a const pointer to the stored value
+      /// @param storage The storage
+      /// @return A const pointer to the stored value
+      static const T *get(const AnyStorage &storage) noexcept
+      {
+        return get(const_cast<AnyStorage &>(storage));
+      }
+
+      /// @brief Destroy the value and release its storage
+      /// @param storage The storage
+      /// @param alloc The allocator used to create the value
+      static void destroy(AnyStorage &storage, Allocator &alloc) noexcept
+      {
+        T *ptr = get(storage);
+        ptr->~T();
+        if constexpr (!isInline())
+        {
+          typename Traits::allocator_type valueAlloc(alloc);
+          Traits::deallocate(valueAlloc, ptr, 1);
+        }
+        else
+        {
+          (void)alloc;
+        }
+      }
+
+      /// @brief Copy the value of src in dst
+      /// @param src The source storage
+      /// @param dst The destination storage, must be empty
+      /// @param alloc The allocator of dst
+      static void copy(const AnyStorage &src, AnyStorage &dst, Allocator &alloc)
+      {
+#if VOC_ENABLE_STATS
+        countAnyClone();
+#endif
+        create(dst, alloc, *get(src));
+      }
+
+      /// @brief Transfer the value of src in dst
+      /// @param src The source storage, left empty
+      /// @param dst The destination storage, must be empty
+      static void move(AnyStorage &src, AnyStorage &dst) noexcept
       {
-        return value;
+#if VOC_ENABLE_STATS
+        countAnyMove();
+#endif
+        if constexpr (isInline())
+        {
+          new (dst.buffer) T(std::move(*get(src)));
+          get(src)->~T();
+        }
+        else
+        {
+          dst.ptr = src.ptr; // heap values are stolen, not moved
+        }
       }
 
-      /// @brief Get the type of the stored value
-      /// @return The type_info of the stored value
-      const std::type_info &type() const override
+      /// @brief Transfer the value of src in dst, allocated with different allocators
+      /// @param src The source storage, left empty
+      /// @param srcAlloc The allocator of src
+      /// @param dst The destination storage, must be empty
+      /// @param dstAlloc The allocator of dst
+      static void relocate(AnyStorage &src, Allocator &srcAlloc, AnyStorage &dst, Allocator &dstAlloc)
       {
-        return typeid(T);
+        if constexpr (isInline())
+        {
+          (void)srcAlloc;
+          (void)dstAlloc;
+          move(src, dst);
+        }
+        else
+        {
+#if VOC_ENABLE_STATS
+          countAnyMove();
+#endif
+          create(dst, dstAlloc, std::move_if_noexcept(*get(src)));
+          destroy(src, srcAlloc);
+        }
       }
 
+      /// @brief Get the copy operation, only instantiated if T can be copied
+      /// @return A pointer to copy, nullptr for move-only types
+      static constexpr auto copyFunction()
+      {
+        if constexpr (std::is_copy_constructible<T>::value)
+        {
+          return &copy;
+        }
+        else
+        {
+          return static_cast<decltype(&copy)>(nullptr);
+        }
+      }
+
+      /// @brief The operations table for T
+#if VOC_HAS_RTTI
+      static constexpr AnyManager<Allocator> manager = {&destroy, copyFunction(), &move, &relocate, voc::typeId<T>(), &typeid(T), isInline()};
+#else
+      static constexpr AnyManager<Allocator> manager = {&destroy, copyFunction(), &move, &relocate, voc::typeId<T>(), isInline()};
+#endif
+    };
+
+    /// @brief Holder of the allocator of Any, empty allocators take no space
+    template <typename Allocator, bool = std::is_empty<Allocator>::value>
+    class AnyAllocatorHolder
+    {
+    public:
+      /// @brief Constructor from an allocator
+      /// @param alloc The allocator
+      explicit AnyAllocatorHolder(const Allocator &alloc) : alloc(alloc) {}
+
+      /// @brief Get the allocator
+      /// @return A reference to the allocator
+      Allocator &allocator() noexcept { return alloc; }
+
+      /// @brief Get the allocator
+      /// @return A const reference to the allocator
+      const Allocator &allocator() const noexcept { return alloc; }
+
     private:
-      T value; ///< The stored value
+      Allocator alloc; ///< The allocator
+    };
+
+    /// @brief Holder of an empty allocator, using the empty base optimization
+    template <typename Allocator>
+    class AnyAllocatorHolder<Allocator, true> : private Allocator
+    {
+    public:
+      /// @brief Constructor from an allocator
+      /// @param alloc The allocator
+      explicit AnyAllocatorHolder(const Allocator &alloc) : Allocator(alloc) {}
+
+      /// @brief Get the allocator
+      /// @return A reference to the allocator
+      Allocator &allocator() noexcept { return *this; }
+
+      /// @brief Get the allocator
+      /// @return A const reference to the allocator
+      const Allocator &allocator() const noexcept { return *this; }
     };
   }
 
@@ -70,21 +343,100 @@ namespace voc
   template <typename T>
   inline constexpr InPlaceTypeStruct<T> InPlaceType = {};
 
+  namespace details
+  {
+    /// @brief Check if a type is an InPlaceTypeStruct
+    template <typename T>
+    struct IsInPlaceType : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct IsInPlaceType<InPlaceTypeStruct<T>> : std::true_type
+    {
+    };
+
+    /// @brief Check if a type wraps an Any object, such types are converted explicitly instead of being stored
+    template <typename T>
+    struct IsAnyWrapper : std::false_type
+    {
+    };
+  }
+
+  template <typename Allocator, bool Copyable = true>
+  class BasicAny;
+
+  namespace details
+  {
+    struct AnyAccess;
+
+    /// @brief Check if a type is a BasicAny
+    template <typename T>
+    struct IsBasicAny : std::false_type
+    {
+    };
+
+    template <typename Allocator, bool Copyable>
+    struct IsBasicAny<BasicAny<Allocator, Copyable>> : std::true_type
+    {
+    };
+
+    /// @brief Parameter type of the copy operations of a move-only BasicAny, never constructed
+    struct AnyNotCopyable
+    {
+      AnyNotCopyable() = delete;
+    };
+  }
+
   /// @brief Class to store any type of value
-  class Any
+  ///
+  /// Values that are nothrow move constructible and small enough are stored in an inline
+  /// buffer, larger values are allocated with the allocator.
+  /// @tparam Allocator The allocator used for the values stored on the heap
+  /// @tparam Copyable Whether the Any object can be copied, if not it also accepts move-only types
+  template <typename Allocator, bool Copyable>
+  class BasicAny : private details::AnyAllocatorHolder<Allocator>
   {
   private:
-    std::unique_ptr<details::AnyBase> content; ///< The stored value
+    using Holder = details::AnyAllocatorHolder<Allocator>;
+    using Traits = std::allocator_traits<Allocator>;
+    using Manager = details::AnyManager<Allocator>;
+
+    template <typename T>
+    using Handler = details::AnyHandler<T, Allocator>;
+
+    /// @brief Parameter type of the copy operations, which cannot be called if the Any object is not copyable
+    using CopySource = std::conditional_t<Copyable, BasicAny, details::AnyNotCopyable>;
+
+    details::AnyStorage storage; ///< The stored value
+    const Manager *manager = nullptr; ///< The operations on the stored value, nullptr if empty
+
+    template <typename A, bool C>
+    friend class BasicAny;
 
   public:
+    /// @brief The type of the allocator
+    using allocator_type = Allocator;
+
     /// @brief Default constructor
-    Any();
+    BasicAny() noexcept(std::is_nothrow_default_constructible<Allocator>::value) : Holder(Allocator()) {}
+
+    /// @brief Constructor from an allocator
+    /// @param alloc The allocator used for the values stored on the heap
+    BasicAny(std::allocator_arg_t, const Allocator &alloc) noexcept : Holder(alloc) {}
 
     /// @brief Constructor from a value
     /// @tparam T The type of the value to be stored
     /// @param value The value to be stored
-    template <typename T, typename std::enable_if<!std::is_same<Any, std::decay_t<T>>::value>::type * = nullptr>
-    Any(T &&value) : content(new details::AnyConcrete<std::decay_t<T>>(std::forward<T>(value))) {}
+    template <typename T, typename std::enable_if<!details::IsBasicAny<std::decay_t<T>>::value && !details::IsInPlaceType<std::decay_t<T>>::value && !details::IsAnyWrapper<std::decay_t<T>>::value>::type * = nullptr>
+    BasicAny(T &&value) : BasicAny(std::allocator_arg, Allocator(), InPlaceType<std::decay_t<T>>, std::forward<T>(value)) {}
+
+    /// @brief Constructor from an allocator and a value
+    /// @tparam T The type of the value to be stored
+    /// @param alloc The allocator used for the values stored on the heap
+    /// @param value The value to be stored
+    template <typename T, typename std::enable_if<!details::IsBasicAny<std::decay_t<T>>::value && !details::IsInPlaceType<std::decay_t<T>>::value && !details::IsAnyWrapper<std::decay_t<T>>::value>::type * = nullptr>
+    BasicAny(std::allocator_arg_t, const Allocator &alloc, T &&value) : BasicAny(std::allocator_arg, alloc, InPlaceType<std::decay_t<T>>, std::forward<T>(value)) {}
 
     /// @brief Constructor from a value and a type struct
     /// @tparam T The type of the value to be stored
@@ -92,66 +444,285 @@ namespace voc
     /// @param type The type struct
     /// @param ...args The arguments to be passed to the constructor of T
     template <typename T, typename... Args>
-    Any(InPlaceTypeStruct<T>, Args &&...args) : content(new details::AnyConcrete<T>(T(std::forward<Args>(args)...))) {}
+    BasicAny(InPlaceTypeStruct<T> type, Args &&...args) : BasicAny(std::allocator_arg, Allocator(), type, std::forward<Args>(args)...) {}
 
-    /// @brief Copy constructor
+    /// @brief Constructor from an allocator, a value and a type struct
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param alloc The allocator used for the values stored on the heap
+    /// @param type The type struct
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename T, typename... Args>
+    BasicAny(std::allocator_arg_t, const Allocator &alloc, InPlaceTypeStruct<T>, Args &&...args) : Holder(alloc)
+    {
+      using U = std::decay_t<T>;
+      static_assert(!Copyable || std::is_copy_constructible<U>::value, "Any: the stored type must be copy constructible, use UniqueAny for move-only types");
+      Handler<U>::create(storage, this->allocator(), std::forward<Args>(args)...);
+      manager = &Handler<U>::manager;
+    }
+
+    /// @brief Copy constructor, not callable if the Any object is not copyable
+    /// @param other The other Any object to be copied
+    BasicAny(const CopySource &other) : BasicAny(std::allocator_arg, Traits::select_on_container_copy_construction(other.allocator()), other) {}
+
+    /// @brief Copy constructor with an allocator
+    /// @param alloc The allocator used for the values stored on the heap
     /// @param other The other Any object to be copied
-    Any(const Any &other) : content(other.content ? other.content->clone() : nullptr) {}
+    BasicAny(std::allocator_arg_t, const Allocator &alloc, const CopySource &other) : Holder(alloc)
+    {
+      if (other.manager)
+      {
+        other.manager->copy(other.storage, storage, this->allocator());
+        manager = other.manager;
+      }
+    }
 
     /// @brief Move constructor
     /// @param other The other Any object to be moved
-    Any(Any &&other) noexcept : content(std::move(other.content)) {}
+    BasicAny(BasicAny &&other) noexcept : Holder(other.allocator()), manager(other.manager)
+    {
+      if (other.manager)
+      {
+        other.manager->move(other.storage, storage);
+        other.manager = nullptr;
+      }
+    }
 
-    /// @brief Copy assignment operator
+    /// @brief Constructor from a copyable Any object, the value is moved without being copied
+    /// @tparam OtherCopyable Whether the other Any object is copyable, only true if this one is not
+    /// @param other The other Any object to be moved
+    template <bool OtherCopyable, typename std::enable_if<OtherCopyable && !Copyable>::type * = nullptr>
+    BasicAny(BasicAny<Allocator, OtherCopyable> &&other) noexcept : Holder(other.allocator()), manager(other.manager)
+    {
+      if (other.manager)
+      {
+        other.manager->move(other.storage, storage);
+        other.manager = nullptr;
+      }
+    }
+
+    /// @brief Move constructor with an allocator
+    ///
+    /// If the allocators are different, the value is moved into a new allocation.
+    /// @param alloc The allocator used for the values stored on the heap
+    /// @param other The other Any object to be moved
+    BasicAny(std::allocator_arg_t, const Allocator &alloc, BasicAny &&other) : Holder(alloc)
+    {
+      if (other.manager)
+      {
+        if (Traits::is_always_equal::value || this->allocator() == other.allocator())
+        {
+          other.manager->move(other.storage, storage);
+        }
+        else
+        {
+          other.manager->relocate(other.storage, other.allocator(), storage, this->allocator());
+        }
+        manager = other.manager;
+        other.manager = nullptr;
+      }
+    }
+
+    /// @brief Destructor
+    ~BasicAny()
+    {
+      clear();
+    }
+
+    /// @brief Copy assignment operator, not callable if the Any object is not copyable
     /// @param other The other Any object to be copied
     /// @return A reference to the current object
-    Any &operator=(const Any &other)
+    BasicAny &operator=(const CopySource &other)
     {
       if (this != &other)
       {
-        content = other.content ? other.content->clone() : nullptr;
+        if constexpr (Traits::propagate_on_container_copy_assignment::value)
+        {
+          *this = BasicAny(std::allocator_arg, other.allocator(), other);
+        }
+        else
+        {
+          *this = BasicAny(std::allocator_arg, this->allocator(), other);
+        }
       }
       return *this;
     }
 
     /// @brief Move assignment operator
+    ///
+    /// If the allocators are different and do not propagate, the value is moved into a new allocation.
     /// @param other The other Any object to be moved
     /// @return A reference to the current object
-    Any &operator=(Any &&other) noexcept
+    BasicAny &operator=(BasicAny &&other) noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value)
     {
-      content = std::move(other.content);
+      if (this != &other)
+      {
+        clear();
+        if constexpr (Traits::propagate_on_container_move_assignment::value)
+        {
+          this->allocator() = std::move(other.allocator());
+        }
+        if (other.manager)
+        {
+          if (Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value || this->allocator() == other.allocator())
+          {
+            other.manager->move(other.storage, storage);
+          }
+          else
+          {
+            other.manager->relocate(other.storage, other.allocator(), storage, this->allocator());
+          }
+          manager = other.manager;
+          other.manager = nullptr;
+        }
+      }
       return *this;
     }
 
+    /// @brief Get the allocator
+    /// @return A copy of the allocator used for the values stored on the heap
+    Allocator getAllocator() const
+    {
+      return this->allocator();
+    }
+
     /// @brief Check if the Any object has a value
     /// @return true if the Any object has a value, false otherwise
-    bool hasValue() const;
+    bool hasValue() const
+    {
+      return manager != nullptr;
+    }
 
-    /// @brief Conversion operator to bool
+    /// @brief Conversion operator to bool, explicit so that an Any object is not taken for a bool or a number
     /// @return true if the Any object has a value, false otherwise
-    operator bool() const;
+    explicit operator bool() const
+    {
+      return hasValue();
+    }
 
     /// @brief Clear the Any object
-    void clear();
+    void clear()
+    {
+      if (manager)
+      {
+        manager->destroy(storage, this->allocator());
+        manager = nullptr;
+      }
+    }
+
+    /// @brief Replace the stored value by a value constructed in place
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the new stored value
+    template <typename T, typename... Args>
+    std::decay_t<T> &emplace(Args &&...args)
+    {
+      using U = std::decay_t<T>;
+      static_assert(!Copyable || std::is_copy_constructible<U>::value, "Any: the stored type must be copy constructible, use UniqueAny for move-only types");
+      clear();
+      Handler<U>::create(storage, this->allocator(), std::forward<Args>(args)...);
+      manager = &Handler<U>::manager;
+      return *Handler<U>::get(storage);
+    }
 
+#if VOC_HAS_RTTI
     /// @brief Get the type of the stored value
-    /// @return The type_info of the stored value
-    const std::type_info &getType() const;
+    /// @return The type_info of the stored value, typeid(void) if the Any object is empty
+    const std::type_info &getType() const
+    {
+      return manager ? *manager->type : typeid(void);
+    }
+#else
+    /// @brief Get the type of the stored value, without RTTI it is the same as getTypeId()
+    /// @return The identifier of the stored type, typeId<void>() if the Any object is empty
+    TypeId getType() const
+    {
+      return getTypeId();
+    }
+#endif
 
-    template <typename T>
-    friend T anyCast(const Any &any);
+    /// @brief Get the identifier of the stored type
+    /// @return The identifier of the stored type, typeId<void>() if the Any object is empty
+    TypeId getTypeId() const
+    {
+      return manager ? manager->typeId : typeId<void>();
+    }
 
+    /// @brief Check if the Any object stores a value of type T
+    /// @tparam T The type to check
+    /// @return true if the stored value is of type T, false otherwise or if the Any object is empty
     template <typename T>
-    friend T *anyCast(Any *any);
+    bool holds() const
+    {
+      return manager == &Handler<std::decay_t<T>>::manager;
+    }
 
-    template <typename T>
-    friend const T *anyCast(const Any *any);
+    friend struct details::AnyAccess;
+
+    template <typename T, typename A, bool C>
+    friend T *anyCast(BasicAny<A, C> *any) noexcept;
+
+    template <typename T, typename A, bool C>
+    friend const T *anyCast(const BasicAny<A, C> *any) noexcept;
 
     /// @brief Get a pointer to the stored value
-    /// @return A pointer to the stored value
-    details::AnyBase *contentPtr() const { return content.get(); };
+    /// @return A pointer to the stored value, nullptr if the Any object is empty
+    const void *contentPtr() const
+    {
+      if (!manager)
+      {
+        return nullptr;
+      }
+      return manager->isInline ? static_cast<const void *>(storage.buffer) : storage.ptr;
+    }
   };
 
+  namespace details
+  {
+    /// @brief Access to the value stored in an Any object, without checking its type
+    struct AnyAccess
+    {
+      /// @brief Get the stored value
+      /// @tparam T The type of the stored value, must be the type of the value
+      /// @param any The Any object
+      /// @return A reference to the stored value
+      template <typename T, typename Allocator, bool Copyable>
+      static T &get(BasicAny<Allocator, Copyable> &any) noexcept
+      {
+        return *AnyHandler<T, Allocator>::get(any.storage);
+      }
+
+      /// @brief Get the stored value
+      /// @tparam T The type of the stored value, must be the type of the value
+      /// @param any The Any object
+      /// @return A const reference to the stored value
+      template <typename T, typename Allocator, bool Copyable>
+      static const T &get(const BasicAny<Allocator, Copyable> &any) noexcept
+      {
+        return *AnyHandler<T, Allocator>::get(any.storage);
+      }
+    };
+  }
+
+  /// @brief Any using the default allocator
+  using Any = BasicAny<std::allocator<std::byte>>;
+
+  extern template class BasicAny<std::allocator<std::byte>>;
+
+  namespace pmr
+  {
+    /// @brief Any using a std::pmr::memory_resource for the values stored on the heap
+    using Any = BasicAny<std::pmr::polymorphic_allocator<std::byte>>;
+  }
+
+  extern template class BasicAny<std::pmr::polymorphic_allocator<std::byte>>;
+
+  /// @brief Any accepting move-only types, it cannot be copied
+  ///
+  /// It is not explicitly instantiated, the copy operations must not be instantiated.
+  using UniqueAny = BasicAny<std::allocator<std::byte>, false>;
+
   /// @brief Create an Any object from a value
   /// @tparam T The type of the value to be stored
   /// @tparam ...Args The type of the arguments to be passed to the constructor of T
@@ -163,59 +734,135 @@ namespace voc
     return Any(InPlaceType<T>, std::forward<Args>(args)...);
   }
 
-  /// @brief Cast an Any object to a T object
+  /// @brief Create a UniqueAny object from a value
+  /// @tparam T The type of the value to be stored
+  /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+  /// @param ...args The arguments to be passed to the constructor of T
+  /// @return A UniqueAny object storing the value
+  template <typename T, typename... Args>
+  UniqueAny makeUniqueAny(Args &&...args)
+  {
+    return UniqueAny(InPlaceType<T>, std::forward<Args>(args)...);
+  }
+
+  /// @brief Cast an Any object to a T pointer
   /// @tparam T The type of the value to be casted
   /// @param any The Any object to be casted
+  /// @return A pointer to the stored value, or nullptr if the cast fails
+  template <typename T, typename Allocator, bool Copyable>
+  T *anyCast(BasicAny<Allocator, Copyable> *any) noexcept
+  {
+#if VOC_ENABLE_STATS
+    details::countAnyCast(any && any->template holds<T>());
+#endif
+    if (any && any->template holds<T>())
+    {
+      return details::AnyHandler<T, Allocator>::get(any->storage);
+    }
+    return nullptr;
+  }
+
+  /// @brief Cast an Any object to a const T pointer
+  /// @tparam T The type of the value to be casted
+  /// @param any The Any object to be casted
+  /// @return A const pointer to the stored value, or nullptr if the cast fails
+  template <typename T, typename Allocator, bool Copyable>
+  const T *anyCast(const BasicAny<Allocator, Copyable> *any) noexcept
+  {
+#if VOC_ENABLE_STATS
+    details::countAnyCast(any && any->template holds<T>());
+#endif
+    if (any && any->template holds<T>())
+    {
+      return details::AnyHandler<T, Allocator>::get(any->storage);
+    }
+    return nullptr;
+  }
+
+  /// @brief Cast an Any object to a T object
+  /// @tparam T The type of the value to be casted, may be a const reference to access the value without copy
+  /// @param any The Any object to be casted
   /// @return An object of type T
-  template <typename T>
-  T anyCast(const Any &any)
+  template <typename T, typename Allocator, bool Copyable>
+  T anyCast(const BasicAny<Allocator, Copyable> &any)
   {
-    if (!any.hasValue() || any.getType() != typeid(T))
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    static_assert(std::is_constructible<T, const U &>::value, "anyCast: T must be constructible from a const lvalue of the stored type");
+    const U *ptr = anyCast<U>(&any);
+    if (!ptr)
     {
       throw std::bad_cast();
     }
+    return static_cast<T>(*ptr);
+  }
 
-    auto concrete = dynamic_cast<details::AnyConcrete<std::decay_t<T>> *>(any.content.get());
-    if (!concrete)
+  /// @brief Cast an Any object to a T object
+  /// @tparam T The type of the value to be casted, may be a reference to access the value without copy
+  /// @param any The Any object to be casted
+  /// @return An object of type T
+  template <typename T, typename Allocator, bool Copyable>
+  T anyCast(BasicAny<Allocator, Copyable> &any)
+  {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    static_assert(std::is_constructible<T, U &>::value, "anyCast: T must be constructible from an lvalue of the stored type");
+    U *ptr = anyCast<U>(&any);
+    if (!ptr)
     {
       throw std::bad_cast();
     }
-    return concrete->getValue();
+    return static_cast<T>(*ptr);
   }
 
-  /// @brief Cast an Any object to a T pointer
-  /// @tparam T The type of the value to be casted
+  /// @brief Cast an rvalue Any object to a T object, the stored value is moved out
+  /// @tparam T The type of the value to be casted, may be an rvalue reference to the stored value
   /// @param any The Any object to be casted
-  /// @return A pointer to an object of type T, or nullptr if the cast fails
-  template <typename T>
-  T anyCast(Any *any)
+  /// @return An object of type T
+  template <typename T, typename Allocator, bool Copyable>
+  T anyCast(BasicAny<Allocator, Copyable> &&any)
   {
-    if (any && any->hasValue() && any->getType() == typeid(T))
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    static_assert(std::is_constructible<T, U>::value, "anyCast: T must be constructible from an rvalue of the stored type");
+    U *ptr = anyCast<U>(&any);
+    if (!ptr)
     {
-      auto concrete = dynamic_cast<details::AnyConcrete<T> *>(any->contentPtr());
-      if (concrete)
-      {
-        return concrete->getValue();
-      }
+      throw std::bad_cast();
     }
-    return nullptr;
+    return static_cast<T>(std::move(*ptr));
   }
 
-  /// @brief Cast an Any object to a const T pointer
+  /// @brief Cast an Any object to a T reference, without exception
   /// @tparam T The type of the value to be casted
   /// @param any The Any object to be casted
-  /// @return A const pointer to an object of type T, or nullptr if the cast fails
-  template <typename T>
-  const T *anyCast(const Any *any)
+  /// @return A reference to the stored value, or no value if the cast fails
+  template <typename T, typename Allocator, bool Copyable>
+  Optional<T &> tryCast(BasicAny<Allocator, Copyable> &any) noexcept
   {
-    auto concrete = dynamic_cast<details::AnyConcrete<T> *>(any->content.get());
-    if (concrete)
-    {
-      return &concrete->getValue();
-    }
-    return nullptr;
+    T *ptr = anyCast<T>(&any);
+    return ptr ? Optional<T &>(*ptr) : Optional<T &>();
+  }
+
+  /// @brief Cast an Any object to a const T reference, without exception
+  /// @tparam T The type of the value to be casted
+  /// @param any The Any object to be casted
+  /// @return A const reference to the stored value, or no value if the cast fails
+  template <typename T, typename Allocator, bool Copyable>
+  Optional<const T &> tryCast(const BasicAny<Allocator, Copyable> &any) noexcept
+  {
+    const T *ptr = anyCast<T>(&any);
+    return ptr ? Optional<const T &>(*ptr) : Optional<const T &>();
+  }
+
+  /// @brief Cast an rvalue Any object to a T object, without exception, the stored value is moved out
+  /// @tparam T The type of the value to be casted
+  /// @param any The Any object to be casted
+  /// @return An Optional object storing the moved value, or no value if the cast fails
+  template <typename T, typename Allocator, bool Copyable>
+  Optional<T> tryCast(BasicAny<Allocator, Copyable> &&any) noexcept(std::is_nothrow_move_constructible<T>::value)
+  {
+    T *ptr = anyCast<T>(&any);
+    return ptr ? Optional<T>(std::move(*ptr)) : Optional<T>();
   }
 
 } // namespace voc
 
-#endif // VOC_ANY_H
\ No newline at end of file
+#endif // VOC_ANY_H
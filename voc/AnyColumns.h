@@ -0,0 +1,386 @@
+#ifndef VOC_ANY_COLUMNS_H
+#define VOC_ANY_COLUMNS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Any.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Base class for the columns of AnyColumns
+    class AnyColumnBase
+    {
+    public:
+      /// @brief Default destructor
+      virtual ~AnyColumnBase() = default;
+
+      /// @brief Add the value stored in an Any object at the end of the column
+      /// @param any The Any object, must store a value of the type of the column
+      /// @return The row of the new value
+      virtual std::size_t pushBack(Any &&any) = 0;
+
+      /// @brief Clone the column
+      /// @return A copy of the column
+      virtual std::unique_ptr<AnyColumnBase> clone() const = 0;
+
+      /// @brief Remove all the values of the column
+      virtual void clear() = 0;
+    };
+
+    /// @brief Column of values of type T
+    template <typename T>
+    class AnyColumn : public AnyColumnBase
+    {
+    public:
+      /// @brief Add the value stored in an Any object at the end of the column
+      /// @param any The Any object, must store a value of type T
+      /// @return The row of the new value
+      std::size_t pushBack(Any &&any) override
+      {
+        values.push_back(anyCast<T>(std::move(any)));
+        return values.size() - 1;
+      }
+
+      /// @brief Clone the column
+      /// @return A copy of the column
+      std::unique_ptr<AnyColumnBase> clone() const override
+      {
+        return std::make_unique<AnyColumn<T>>(*this);
+      }
+
+      /// @brief Remove all the values of the column
+      void clear() override
+      {
+        values.clear();
+      }
+
+      std::vector<T> values; ///< The values, in insertion order
+    };
+  }
+
+  /// @brief Container of values of any type, grouped by type in contiguous columns
+  ///
+  /// Each registered type has its own std::vector, so a loop over the values of one
+  /// type needs no type check. The values of the types that are not registered are
+  /// kept in a column of Any objects. The insertion order is kept in an index.
+  ///
+  /// bool has no column, as std::vector<bool> has no references to its elements: its values
+  /// are always kept in the column of Any objects.
+  class AnyColumns
+  {
+  private:
+    /// @brief Location of a value
+    struct Location
+    {
+      std::size_t column; ///< The index of the column
+      std::size_t row;    ///< The index of the value in the column
+    };
+
+    static constexpr std::size_t GenericColumn = std::numeric_limits<std::size_t>::max(); ///< The column of Any objects
+
+    std::vector<Location> order;                                 ///< The location of the values, in insertion order
+    std::vector<std::unique_ptr<details::AnyColumnBase>> columns; ///< The columns of the registered types
+    std::vector<TypeId> columnTypes;                             ///< The type of each column
+    std::unordered_map<TypeId, std::size_t> columnIndex;         ///< The index of the column of each registered type
+    std::vector<Any> generic;                                    ///< The values of the types that are not registered
+
+  public:
+    /// @brief Default constructor
+    AnyColumns() = default;
+
+    /// @brief Copy constructor
+    /// @param other The other AnyColumns object to be copied
+    AnyColumns(const AnyColumns &other) : order(other.order), columnTypes(other.columnTypes), columnIndex(other.columnIndex), generic(other.generic)
+    {
+      columns.reserve(other.columns.size());
+      for (const auto &column : other.columns)
+      {
+        columns.push_back(column->clone());
+      }
+    }
+
+    /// @brief Move constructor
+    /// @param other The other AnyColumns object to be moved
+    AnyColumns(AnyColumns &&other) = default;
+
+    /// @brief Copy assignment operator
+    /// @param other The other AnyColumns object to be copied
+    /// @return A reference to the current object
+    AnyColumns &operator=(const AnyColumns &other)
+    {
+      if (this != &other)
+      {
+        *this = AnyColumns(other);
+      }
+      return *this;
+    }
+
+    /// @brief Move assignment operator
+    /// @param other The other AnyColumns object to be moved
+    /// @return A reference to the current object
+    AnyColumns &operator=(AnyColumns &&other) = default;
+
+    /// @brief Create the column of a type
+    ///
+    /// Values of type T that were added before are kept in the column of Any objects.
+    /// @tparam T The type of the column
+    template <typename T>
+    void registerType()
+    {
+      columnOf<std::decay_t<T>>();
+    }
+
+    /// @brief Get the number of values
+    /// @return The number of values
+    std::size_t size() const
+    {
+      return order.size();
+    }
+
+    /// @brief Check if the AnyColumns object has no value
+    /// @return true if there is no value, false otherwise
+    bool empty() const
+    {
+      return order.empty();
+    }
+
+    /// @brief Remove all the values, the registered types are kept
+    void clear()
+    {
+      order.clear();
+      for (auto &column : columns)
+      {
+        column->clear();
+      }
+      generic.clear();
+    }
+
+    /// @brief Add a value at the end, the column of its type is created if needed
+    /// @tparam T The type of the value to be stored
+    /// @param value The value to be stored
+    template <typename T, typename std::enable_if<!std::is_same<Any, std::decay_t<T>>::value>::type * = nullptr>
+    void pushBack(T &&value)
+    {
+      using U = std::decay_t<T>;
+      if constexpr (std::is_same<U, bool>::value)
+      {
+        pushBack(Any(value));
+      }
+      else
+      {
+        std::size_t index = columnOf<U>();
+        std::vector<U> &values = static_cast<details::AnyColumn<U> &>(*columns[index]).values;
+        order.push_back(Location{index, values.size()});
+        try
+        {
+          values.push_back(std::forward<T>(value));
+        }
+        catch (...)
+        {
+          order.pop_back();
+          throw;
+        }
+      }
+    }
+
+    /// @brief Add the value stored in an Any object at the end
+    ///
+    /// The value goes to the column of its type if it is registered, to the column of Any objects otherwise.
+    /// @param any The Any object
+    void pushBack(Any &&any)
+    {
+      auto found = columnIndex.find(any.getTypeId());
+      std::size_t index = found == columnIndex.end() ? GenericColumn : found->second;
+      order.push_back(Location{index, 0});
+      try
+      {
+        if (index == GenericColumn)
+        {
+          generic.push_back(std::move(any));
+          order.back().row = generic.size() - 1;
+        }
+        else
+        {
+          order.back().row = columns[index]->pushBack(std::move(any));
+        }
+      }
+      catch (...)
+      {
+        order.pop_back();
+        throw;
+      }
+    }
+
+    /// @brief Add the value stored in an Any object at the end
+    /// @param any The Any object to be copied
+    void pushBack(const Any &any)
+    {
+      pushBack(Any(any));
+    }
+
+    /// @brief Get the identifier of the type of a value
+    /// @param index The index of the value, in insertion order
+    /// @return The identifier of the type of the value
+    TypeId getTypeId(std::size_t index) const
+    {
+      const Location &location = order[index];
+      if (location.column == GenericColumn)
+      {
+        return generic[location.row].getTypeId();
+      }
+      return columnTypes[location.column];
+    }
+
+    /// @brief Check if a value is of type T
+    /// @tparam T The type to check
+    /// @param index The index of the value, in insertion order
+    /// @return true if the value is of type T, false otherwise
+    template <typename T>
+    bool holds(std::size_t index) const
+    {
+      return getTypeId(index) == typeId<std::decay_t<T>>();
+    }
+
+    /// @brief Get a value
+    /// @tparam T The type of the value
+    /// @param index The index of the value, in insertion order
+    /// @return A const reference to the value
+    /// @throw std::bad_cast if the value is not of type T
+    template <typename T>
+    const std::decay_t<T> &get(std::size_t index) const
+    {
+      using U = std::decay_t<T>;
+      const Location &location = order[index];
+      if (location.column == GenericColumn)
+      {
+        return anyCast<const U &>(generic[location.row]);
+      }
+      if constexpr (std::is_same<U, bool>::value)
+      {
+        throw std::bad_cast(); // bool values are never in a column
+      }
+      else
+      {
+        if (columnTypes[location.column] != typeId<U>())
+        {
+          throw std::bad_cast();
+        }
+        return static_cast<const details::AnyColumn<U> &>(*columns[location.column]).values[location.row];
+      }
+    }
+
+    /// @brief Get the column of a type
+    /// @tparam T The type of the column
+    /// @return A pointer to the values of type T in insertion order, or nullptr if the type is not registered
+    template <typename T>
+    const std::vector<std::decay_t<T>> *getColumn() const
+    {
+      using U = std::decay_t<T>;
+      static_assert(!std::is_same<U, bool>::value, "AnyColumns: bool values are kept in the column of Any objects");
+      auto found = columnIndex.find(typeId<U>());
+      if (found == columnIndex.end())
+      {
+        return nullptr;
+      }
+      return &static_cast<const details::AnyColumn<U> &>(*columns[found->second]).values;
+    }
+
+    /// @brief Call a function on every value of type T
+    ///
+    /// The values of the column of T are visited first, in a loop without type check,
+    /// then the values of type T stored in Any objects.
+    /// @tparam T The type of the values
+    /// @tparam F The type of the function
+    /// @param f The function, called with a reference to each value of type T
+    template <typename T, typename F>
+    void forEachOfType(F &&f)
+    {
+      using U = std::decay_t<T>;
+      if constexpr (!std::is_same<U, bool>::value)
+      {
+        auto found = columnIndex.find(typeId<U>());
+        if (found != columnIndex.end())
+        {
+          for (U &value : static_cast<details::AnyColumn<U> &>(*columns[found->second]).values)
+          {
+            f(value);
+          }
+        }
+      }
+      for (Any &any : generic)
+      {
+        if (U *value = anyCast<U>(&any))
+        {
+          f(*value);
+        }
+      }
+    }
+
+    /// @brief Call a function on every value of type T
+    /// @tparam T The type of the values
+    /// @tparam F The type of the function
+    /// @param f The function, called with a const reference to each value of type T
+    template <typename T, typename F>
+    void forEachOfType(F &&f) const
+    {
+      using U = std::decay_t<T>;
+      if constexpr (!std::is_same<U, bool>::value)
+      {
+        if (const std::vector<U> *values = getColumn<U>())
+        {
+          for (const U &value : *values)
+          {
+            f(value);
+          }
+        }
+      }
+      for (const Any &any : generic)
+      {
+        if (const U *value = anyCast<U>(&any))
+        {
+          f(*value);
+        }
+      }
+    }
+
+  private:
+    /// @brief Get the column of a type, created if needed
+    /// @tparam T The type of the column
+    /// @return The index of the column
+    template <typename T>
+    std::size_t columnOf()
+    {
+      static_assert(!std::is_same<T, Any>::value, "AnyColumns: Any values are dispatched to the column of their type");
+      static_assert(!std::is_same<T, bool>::value, "AnyColumns: std::vector<bool> has no references to its elements, bool values are kept in the column of Any objects");
+      auto found = columnIndex.find(typeId<T>());
+      if (found != columnIndex.end())
+      {
+        return found->second;
+      }
+      auto created = std::make_unique<details::AnyColumn<T>>();
+      if (columns.size() == columns.capacity() || columnTypes.size() == columnTypes.capacity())
+      {
+        std::size_t capacity = std::max<std::size_t>(2 * columns.size(), 4); // geometric, adding types stays linear
+        columns.reserve(capacity);
+        columnTypes.reserve(capacity);
+      }
+      columnIndex.emplace(typeId<T>(), columns.size());
+      columns.push_back(std::move(created)); // cannot throw, the memory is reserved
+      columnTypes.push_back(typeId<T>());
+      return columns.size() - 1;
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_ANY_COLUMNS_H
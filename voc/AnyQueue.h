@@ -0,0 +1,399 @@
+#ifndef VOC_ANY_QUEUE_H
+#define VOC_ANY_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "Any.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Slot of AnyQueue, on its own cache line
+    ///
+    /// The sequence tells the state of the slot for a position of the queue: equal to the
+    /// position when it is free for a producer, to the position plus one when it holds the
+    /// value for a consumer.
+    struct alignas(64) AnyQueueSlot
+    {
+      std::atomic<std::size_t> sequence; ///< The position for which the slot is free or full
+      UniqueAny value;                   ///< The message, stored inline if it is small enough
+    };
+
+    /// @brief Position of the producers or of the consumers of AnyQueue, on its own cache line
+    struct alignas(64) AnyQueuePosition
+    {
+      std::atomic<std::size_t> value{0}; ///< The next position to be claimed
+    };
+
+    /// @brief Number of threads blocked in AnyQueue, on its own cache line as it is read by every operation
+    struct alignas(64) AnyQueueWaiters
+    {
+      std::atomic<std::size_t> producers{0}; ///< The number of producers waiting for a free slot
+      std::atomic<std::size_t> consumers{0}; ///< The number of consumers waiting for a message
+    };
+  }
+
+  /// @brief Bounded multi-producer multi-consumer queue of messages of any type
+  ///
+  /// The messages are UniqueAny objects, so move-only values can be passed, and Any objects are
+  /// converted without copy. They are moved into a ring of slots allocated once: values small
+  /// enough for the inline buffer of Any never touch the heap, larger ones keep their heap node.
+  ///
+  /// The try operations never block: each claims a range of positions with a single compare and
+  /// swap, then moves the messages in or out and publishes the slots, so a batch of N messages
+  /// costs one contended atomic operation instead of N. The blocking operations spin a little,
+  /// then wait on a condition variable; the other side only takes the mutex to wake them if
+  /// some thread is actually waiting.
+  class AnyQueue
+  {
+  private:
+    static constexpr int SpinCount = 64; ///< The number of attempts of a blocking operation before waiting
+
+    std::size_t mask;                                  ///< The capacity minus one
+    std::unique_ptr<details::AnyQueueSlot[]> slots;    ///< The ring of slots
+    details::AnyQueuePosition head;                    ///< The next position to push
+    details::AnyQueuePosition tail;                    ///< The next position to pop
+    details::AnyQueueWaiters waiters;                  ///< The blocked threads
+    std::mutex mutex;                                  ///< Protects the waits on the condition variables
+    std::condition_variable notFull;                   ///< Signaled when slots are freed
+    std::condition_variable notEmpty;                  ///< Signaled when messages are pushed
+
+    /// @brief Get the smallest power of two not below a capacity, at least 2
+    /// @param capacity The requested capacity
+    /// @return The capacity of the ring
+    static std::size_t roundCapacity(std::size_t capacity) noexcept
+    {
+      std::size_t result = 2;
+      while (result < capacity)
+      {
+        result <<= 1;
+      }
+      return result;
+    }
+
+    /// @brief Claim consecutive positions whose slots are ready
+    /// @param position The position of the producers or consumers
+    /// @param offset 0 to claim free slots, 1 to claim full slots
+    /// @param count The maximum number of positions to claim
+    /// @param first The first claimed position, set if some are claimed
+    /// @return The number of claimed positions, 0 if the queue is full or empty
+    std::size_t claim(details::AnyQueuePosition &position, std::size_t offset, std::size_t count, std::size_t &first) noexcept
+    {
+      std::size_t pos = position.value.load(std::memory_order_relaxed);
+      while (true)
+      {
+        std::size_t ready = 0;
+        std::intptr_t difference = 0;
+        while (ready < count)
+        {
+          std::size_t sequence = slots[(pos + ready) & mask].sequence.load(std::memory_order_acquire);
+          difference = static_cast<std::intptr_t>(sequence - (pos + ready + offset));
+          if (difference != 0)
+          {
+            break;
+          }
+          ++ready;
+        }
+        if (ready == 0)
+        {
+          if (difference < 0)
+          {
+            return 0; // the slot is still used for the previous turn of the ring
+          }
+          pos = position.value.load(std::memory_order_relaxed); // another thread claimed it
+          continue;
+        }
+        if (position.value.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+        {
+          first = pos;
+          return ready;
+        }
+      }
+    }
+
+    /// @brief Push messages without waking the consumers
+    /// @param values The messages, moved from if they are pushed
+    /// @param count The number of messages
+    /// @return The number of messages pushed, the first ones
+    std::size_t pushSome(UniqueAny *values, std::size_t count) noexcept
+    {
+      std::size_t first;
+      std::size_t claimed = claim(head, 0, count, first);
+      for (std::size_t i = 0; i < claimed; ++i)
+      {
+        details::AnyQueueSlot &slot = slots[(first + i) & mask];
+        slot.value = std::move(values[i]);
+        slot.sequence.store(first + i + 1, std::memory_order_release);
+      }
+      return claimed;
+    }
+
+    /// @brief Pop messages without waking the producers
+    /// @param values The destinations of the messages
+    /// @param count The maximum number of messages
+    /// @return The number of messages popped
+    std::size_t popSome(UniqueAny *values, std::size_t count) noexcept
+    {
+      std::size_t first;
+      std::size_t claimed = claim(tail, 1, count, first);
+      for (std::size_t i = 0; i < claimed; ++i)
+      {
+        details::AnyQueueSlot &slot = slots[(first + i) & mask];
+        values[i] = std::move(slot.value);
+        slot.sequence.store(first + i + mask + 1, std::memory_order_release);
+      }
+      return claimed;
+    }
+
+    /// @brief Wake the threads waiting on a condition variable, if any
+    /// @param count The number of threads waiting
+    /// @param condition The condition variable
+    /// @param all Whether to wake all the threads or only one
+    void wake(std::atomic<std::size_t> &count, std::condition_variable &condition, bool all)
+    {
+      // Pairs with the fence of wait(): either the waiter sees the published slots, or this
+      // thread sees the waiter.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (count.load(std::memory_order_relaxed) == 0)
+      {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex); // the waiter is either before its check or waiting
+      }
+      if (all)
+      {
+        condition.notify_all();
+      }
+      else
+      {
+        condition.notify_one();
+      }
+    }
+
+    /// @brief Retry an operation until it succeeds, spinning then waiting on a condition variable
+    /// @tparam F The type of the operation
+    /// @param count The number of threads waiting, incremented while waiting
+    /// @param condition The condition variable
+    /// @param attempt The operation, returns true if it succeeded
+    template <typename F>
+    void wait(std::atomic<std::size_t> &count, std::condition_variable &condition, F &&attempt)
+    {
+      for (int spin = 0; spin < SpinCount; ++spin)
+      {
+        if (attempt())
+        {
+          return;
+        }
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      count.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      condition.wait(lock, attempt);
+      count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+  public:
+    /// @brief Constructor
+    /// @param capacity The maximum number of messages, rounded up to a power of two
+    explicit AnyQueue(std::size_t capacity) : mask(roundCapacity(capacity) - 1), slots(new details::AnyQueueSlot[mask + 1])
+    {
+      for (std::size_t i = 0; i <= mask; ++i)
+      {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    AnyQueue(const AnyQueue &) = delete;
+    AnyQueue &operator=(const AnyQueue &) = delete;
+
+    /// @brief Get the capacity
+    /// @return The maximum number of messages
+    std::size_t capacity() const noexcept
+    {
+      return mask + 1;
+    }
+
+    /// @brief Get the number of messages, exact only if no thread is pushing or popping
+    /// @return The number of messages
+    std::size_t approximateSize() const noexcept
+    {
+      std::size_t popped = tail.value.load(std::memory_order_relaxed);
+      std::size_t pushed = head.value.load(std::memory_order_relaxed);
+      return pushed > popped ? pushed - popped : 0;
+    }
+
+    /// @brief Push a message if the queue is not full
+    ///
+    /// An Any object is first converted to a temporary UniqueAny object, so its value is lost
+    /// if the queue is full; convert it beforehand to keep it.
+    /// @param value The message, moved from only if it is pushed
+    /// @return true if the message was pushed, false if the queue is full
+    bool tryPush(UniqueAny &&value)
+    {
+      if (pushSome(&value, 1) == 0)
+      {
+        return false;
+      }
+      wake(waiters.consumers, notEmpty, false);
+      return true;
+    }
+
+    /// @brief Push a message constructed in place if the queue is not full
+    ///
+    /// Values stored inline and nothrow constructible are constructed directly in their slot.
+    /// @tparam T The type of the value to be pushed
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return true if the message was pushed, false if the queue is full
+    template <typename T, typename... Args>
+    bool tryEmplace(Args &&...args)
+    {
+      using U = std::decay_t<T>;
+      if constexpr (details::AnyFitsInline<U> && std::is_nothrow_constructible<U, Args...>::value)
+      {
+        std::size_t first;
+        if (claim(head, 0, 1, first) == 0)
+        {
+          return false;
+        }
+        details::AnyQueueSlot &slot = slots[first & mask];
+        slot.value.template emplace<U>(std::forward<Args>(args)...);
+        slot.sequence.store(first + 1, std::memory_order_release);
+        wake(waiters.consumers, notEmpty, false);
+        return true;
+      }
+      else
+      {
+        // The construction may throw, so it is done before a slot is claimed
+        return tryPush(UniqueAny(InPlaceType<U>, std::forward<Args>(args)...));
+      }
+    }
+
+    /// @brief Push as many messages as there are free slots
+    /// @param values The messages, the pushed ones are moved from
+    /// @param count The number of messages
+    /// @return The number of messages pushed, the first ones
+    std::size_t tryPushN(UniqueAny *values, std::size_t count)
+    {
+      std::size_t pushed = 0;
+      std::size_t claimed;
+      while (pushed < count && (claimed = pushSome(values + pushed, count - pushed)) != 0)
+      {
+        pushed += claimed; // a short claim stops at a slot still being popped, retry from it in case it was released meanwhile
+      }
+      if (pushed != 0)
+      {
+        wake(waiters.consumers, notEmpty, pushed > 1);
+      }
+      return pushed;
+    }
+
+    /// @brief Pop a message if the queue is not empty
+    /// @param value The destination of the message
+    /// @return true if a message was popped, false if the queue is empty
+    bool tryPop(UniqueAny &value)
+    {
+      if (popSome(&value, 1) == 0)
+      {
+        return false;
+      }
+      wake(waiters.producers, notFull, false);
+      return true;
+    }
+
+    /// @brief Pop as many messages as are available
+    /// @param values The destinations of the messages
+    /// @param count The maximum number of messages
+    /// @return The number of messages popped
+    std::size_t tryPopN(UniqueAny *values, std::size_t count)
+    {
+      std::size_t popped = 0;
+      std::size_t claimed;
+      while (popped < count && (claimed = popSome(values + popped, count - popped)) != 0)
+      {
+        popped += claimed;
+      }
+      if (popped != 0)
+      {
+        wake(waiters.producers, notFull, popped > 1);
+      }
+      return popped;
+    }
+
+    /// @brief Push a message, waiting for a free slot if the queue is full
+    /// @param value The message
+    void push(UniqueAny &&value)
+    {
+      wait(waiters.producers, notFull, [&] { return pushSome(&value, 1) != 0; });
+      wake(waiters.consumers, notEmpty, false);
+    }
+
+    /// @brief Push a message constructed in place, waiting for a free slot if the queue is full
+    /// @tparam T The type of the value to be pushed
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename T, typename... Args>
+    void emplace(Args &&...args)
+    {
+      push(UniqueAny(InPlaceType<std::decay_t<T>>, std::forward<Args>(args)...));
+    }
+
+    /// @brief Push messages, waiting for free slots while the queue is full
+    /// @param values The messages, all moved from
+    /// @param count The number of messages
+    void pushN(UniqueAny *values, std::size_t count)
+    {
+      std::size_t pushed = 0;
+      while (pushed < count)
+      {
+        wait(waiters.producers, notFull, [&] {
+          std::size_t claimed = pushSome(values + pushed, count - pushed);
+          pushed += claimed;
+          return claimed != 0;
+        });
+        wake(waiters.consumers, notEmpty, true);
+      }
+    }
+
+    /// @brief Pop a message, waiting for one if the queue is empty
+    /// @return The message
+    UniqueAny pop()
+    {
+      UniqueAny value;
+      wait(waiters.consumers, notEmpty, [&] { return popSome(&value, 1) != 0; });
+      wake(waiters.producers, notFull, false);
+      return value;
+    }
+
+    /// @brief Pop at least one message, waiting for one if the queue is empty
+    /// @param values The destinations of the messages
+    /// @param count The maximum number of messages, nothing is popped and the call does not wait if it is 0
+    /// @return The number of messages popped
+    std::size_t popN(UniqueAny *values, std::size_t count)
+    {
+      if (count == 0)
+      {
+        return 0;
+      }
+      std::size_t popped = 0;
+      wait(waiters.consumers, notEmpty, [&] {
+        popped = popSome(values, count);
+        return popped != 0;
+      });
+      wake(waiters.producers, notFull, popped > 1);
+      return popped;
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_ANY_QUEUE_H
@@ -0,0 +1,227 @@
+#include "AnyStats.h"
+
+#if VOC_ENABLE_STATS
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#endif
+
+namespace voc
+{
+#if VOC_ENABLE_STATS
+  namespace
+  {
+    /// @brief Number of types in the histogram of each thread, a power of two
+    constexpr std::size_t TypeSlots = 64;
+
+    /// @brief Counter written by a single thread and read by any thread
+    ///
+    /// The owner does a relaxed load and store instead of an atomic increment,
+    /// so counting costs the same as a plain increment.
+    class Counter
+    {
+    public:
+      /// @brief Add to the counter, only called by the owner thread
+      /// @param n The value to add
+      void add(std::uint64_t n) noexcept
+      {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+      }
+
+      /// @brief Read the counter
+      /// @return The current value
+      std::uint64_t get() const noexcept
+      {
+        return value.load(std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<std::uint64_t> value{0}; ///< The value
+    };
+
+    /// @brief Counters of one thread
+    struct Shard
+    {
+      Counter allocations;    ///< The number of values allocated on the heap
+      Counter allocatedBytes; ///< The total size of the values allocated on the heap
+      Counter clones;         ///< The number of values copied
+      Counter moves;          ///< The number of values moved
+      Counter castHits;       ///< The number of successful casts
+      Counter castMisses;     ///< The number of failed casts
+      Counter otherValues;    ///< The values whose type did not fit in the histogram
+
+      std::atomic<TypeId> typeIds[TypeSlots]{}; ///< The types of the histogram, nullptr for an empty slot, published last
+#if VOC_HAS_RTTI
+      const std::type_info *types[TypeSlots]{}; ///< The type_info of each type
+#endif
+      Counter typeValues[TypeSlots]; ///< The number of values of each type
+    };
+
+    /// @brief Add the counters of a shard to a snapshot
+    /// @param stats The snapshot
+    /// @param shard The shard
+    void merge(AnyStats &stats, const Shard &shard)
+    {
+      stats.allocations += shard.allocations.get();
+      stats.allocatedBytes += shard.allocatedBytes.get();
+      stats.clones += shard.clones.get();
+      stats.moves += shard.moves.get();
+      stats.castHits += shard.castHits.get();
+      stats.castMisses += shard.castMisses.get();
+      stats.otherValues += shard.otherValues.get();
+      for (std::size_t slot = 0; slot < TypeSlots; ++slot)
+      {
+        TypeId id = shard.typeIds[slot].load(std::memory_order_acquire);
+        if (id == nullptr)
+        {
+          continue;
+        }
+        auto it = std::find_if(stats.types.begin(), stats.types.end(), [&](const AnyTypeStats &entry) { return entry.typeId == id; });
+        if (it == stats.types.end())
+        {
+#if VOC_HAS_RTTI
+          it = stats.types.insert(it, AnyTypeStats{id, shard.types[slot], 0});
+#else
+          it = stats.types.insert(it, AnyTypeStats{id, 0});
+#endif
+        }
+        it->values += shard.typeValues[slot].get();
+      }
+    }
+
+    /// @brief The shards of the running threads and the counters of the finished ones
+    struct Registry
+    {
+      std::mutex mutex;           ///< Protects the members
+      std::vector<Shard *> shards; ///< The shards of the running threads
+      AnyStats retired;           ///< The counters of the finished threads
+    };
+
+    /// @brief Get the registry, never destroyed so that threads can finish during the exit of the program
+    /// @return The registry
+    Registry &registry()
+    {
+      static Registry *instance = new Registry();
+      return *instance;
+    }
+
+    /// @brief Owner of the shard of a thread, registered while the thread runs
+    struct ShardOwner
+    {
+      /// @brief Constructor, register the shard
+      ShardOwner()
+      {
+        Registry &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        instance.shards.push_back(&shard);
+      }
+
+      /// @brief Destructor, keep the counters in the registry and unregister the shard
+      ~ShardOwner()
+      {
+        Registry &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        merge(instance.retired, shard);
+        instance.shards.erase(std::find(instance.shards.begin(), instance.shards.end(), &shard));
+      }
+
+      Shard shard; ///< The counters of the thread
+    };
+
+    /// @brief Get the shard of the calling thread
+    /// @return The shard
+    Shard &localShard() noexcept
+    {
+      thread_local ShardOwner owner;
+      return owner.shard;
+    }
+
+    /// @brief Find the slot of the histogram of the calling thread for a type, insert it if needed
+    /// @param shard The shard of the calling thread
+    /// @param id The identifier of the type
+    /// @return The slot, TypeSlots if the histogram is full
+    std::size_t findSlot(Shard &shard, TypeId id) noexcept
+    {
+      std::uint64_t value = reinterpret_cast<std::uintptr_t>(id);
+      std::size_t slot = static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 32) & (TypeSlots - 1);
+      for (std::size_t probe = 0; probe < TypeSlots; ++probe, slot = (slot + 1) & (TypeSlots - 1))
+      {
+        TypeId current = shard.typeIds[slot].load(std::memory_order_relaxed);
+        if (current == id || current == nullptr)
+        {
+          return slot;
+        }
+      }
+      return TypeSlots;
+    }
+  }
+
+  namespace details
+  {
+#if VOC_HAS_RTTI
+    void countAnyValue(TypeId id, const std::type_info *type) noexcept
+#else
+    void countAnyValue(TypeId id) noexcept
+#endif
+    {
+      Shard &shard = localShard();
+      std::size_t slot = findSlot(shard, id);
+      if (slot == TypeSlots)
+      {
+        shard.otherValues.add(1);
+        return;
+      }
+      if (shard.typeIds[slot].load(std::memory_order_relaxed) == nullptr)
+      {
+#if VOC_HAS_RTTI
+        shard.types[slot] = type;
+#endif
+        shard.typeIds[slot].store(id, std::memory_order_release);
+      }
+      shard.typeValues[slot].add(1);
+    }
+
+    void countAnyAllocation(std::size_t bytes) noexcept
+    {
+      Shard &shard = localShard();
+      shard.allocations.add(1);
+      shard.allocatedBytes.add(bytes);
+    }
+
+    void countAnyClone() noexcept
+    {
+      localShard().clones.add(1);
+    }
+
+    void countAnyMove() noexcept
+    {
+      localShard().moves.add(1);
+    }
+
+    void countAnyCast(bool hit) noexcept
+    {
+      Shard &shard = localShard();
+      (hit ? shard.castHits : shard.castMisses).add(1);
+    }
+  }
+
+  AnyStats stats()
+  {
+    Registry &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    AnyStats result = instance.retired;
+    for (const Shard *shard : instance.shards)
+    {
+      merge(result, *shard);
+    }
+    std::sort(result.types.begin(), result.types.end(), [](const AnyTypeStats &a, const AnyTypeStats &b) { return a.values > b.values; });
+    return result;
+  }
+#else
+  AnyStats stats()
+  {
+    return AnyStats();
+  }
+#endif
+
+} // namespace voc
@@ -0,0 +1,64 @@
+#ifndef VOC_ANY_STATS_H
+#define VOC_ANY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+#include <vector>
+
+#include "Any.h"
+
+namespace voc
+{
+  /// @brief Number of values created for one type
+  struct AnyTypeStats
+  {
+    TypeId typeId;              ///< The identifier of the type
+#if VOC_HAS_RTTI
+    const std::type_info *type; ///< The type, as returned by Any::getType()
+#endif
+    std::uint64_t values;       ///< The number of values created, copies included
+  };
+
+  /// @brief Snapshot of the counters of Any, for all the threads since the start of the program
+  ///
+  /// The counters are only maintained if VOC_ENABLE_STATS is defined to 1 when building
+  /// every file including Any.h, otherwise they are all zero. Each thread counts in its own
+  /// shard, without synchronization, and the shards of finished threads are kept.
+  struct AnyStats
+  {
+    std::uint64_t allocations = 0;    ///< The number of values allocated on the heap
+    std::uint64_t allocatedBytes = 0; ///< The total size of the values allocated on the heap
+    std::uint64_t clones = 0;         ///< The number of values copied
+    std::uint64_t moves = 0;          ///< The number of values moved, including stolen heap values
+    std::uint64_t castHits = 0;       ///< The number of successful casts
+    std::uint64_t castMisses = 0;     ///< The number of casts to another type than the stored one
+    std::vector<AnyTypeStats> types;  ///< The number of values by type, sorted by decreasing number
+    std::uint64_t otherValues = 0;    ///< The values whose type did not fit in the histogram of their thread
+
+    /// @brief Get the number of values created for a type
+    /// @param id The identifier of the type
+    /// @return The number of values, 0 if the type is not in the histogram
+    std::uint64_t valuesOf(TypeId id) const noexcept
+    {
+      for (const AnyTypeStats &entry : types)
+      {
+        if (entry.typeId == id)
+        {
+          return entry.values;
+        }
+      }
+      return 0;
+    }
+  };
+
+  /// @brief Get a snapshot of the counters of Any
+  ///
+  /// The counters of the running threads are read while they may be updated, so a snapshot
+  /// is not atomic, but each counter is exact once the threads have stopped using Any.
+  /// @return The counters, all zero if VOC_ENABLE_STATS is not enabled
+  AnyStats stats();
+
+} // namespace voc
+
+#endif // VOC_ANY_STATS_H
@@ -0,0 +1,516 @@
+#ifndef VOC_ANY_VECTOR_H
+#define VOC_ANY_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Any.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Table of the operations on a type stored in AnyVector
+    struct AnyVectorOps
+    {
+      /// @brief Destroy the value
+      void (*destroy)(void *value) noexcept;
+
+      /// @brief Copy construct the value of src in dst
+      void (*copy)(const void *src, void *dst);
+
+      /// @brief Move construct the value of src in dst, then destroy src
+      void (*relocate)(void *src, void *dst) noexcept;
+
+      /// @brief The identifier of the stored type
+      TypeId typeId;
+
+      /// @brief Whether the value can be relocated with memcpy and needs no destructor
+      bool isTrivial;
+
+      /// @brief Whether relocate is available, copy is used otherwise
+      bool isNothrowMovable;
+    };
+
+    /// @brief Implementation of the operations of AnyVectorOps for a type T
+    template <typename T>
+    struct AnyVectorHandler
+    {
+      /// @brief Destroy the value
+      /// @param value The value
+      static void destroy(void *value) noexcept
+      {
+        static_cast<T *>(value)->~T();
+      }
+
+      /// @brief Copy construct the value of src in dst
+      /// @param src The source value
+      /// @param dst The destination storage
+      static void copy(const void *src, void *dst)
+      {
+        new (dst) T(*static_cast<const T *>(src));
+      }
+
+      /// @brief Move construct the value of src in dst, then destroy src
+      /// @param src The source value
+      /// @param dst The destination storage
+      static void relocate(void *src, void *dst) noexcept
+      {
+        if constexpr (std::is_nothrow_move_constructible<T>::value)
+        {
+          new (dst) T(std::move(*static_cast<T *>(src)));
+          destroy(src);
+        }
+        else
+        {
+          (void)src;
+          (void)dst;
+        }
+      }
+
+      /// @brief The operations table for T
+      static constexpr AnyVectorOps ops = {&destroy, &copy, &relocate, voc::typeId<T>(), std::is_trivially_copyable<T>::value, std::is_nothrow_move_constructible<T>::value};
+    };
+  }
+
+  /// @brief Container of values of any type, stored back to back in one buffer
+  ///
+  /// Each element has a header with its operations and its offset in the buffer, so
+  /// iterating the elements is a linear scan of memory. Over-aligned types are not supported.
+  class AnyVector
+  {
+  private:
+    /// @brief Header of an element
+    struct Entry
+    {
+      const details::AnyVectorOps *ops; ///< The operations on the element
+      std::size_t offset;               ///< The offset of the element in the buffer
+    };
+
+    std::vector<Entry> entries; ///< The headers of the elements
+    std::byte *buffer = nullptr; ///< The values
+    std::size_t used = 0;        ///< The number of bytes used in buffer
+    std::size_t capacity = 0;    ///< The number of bytes allocated for buffer
+    std::size_t nonTrivialCount = 0; ///< The number of elements that are not trivially copyable
+    std::size_t throwingMoveCount = 0; ///< The number of elements that can throw when moved
+
+  public:
+    /// @brief Default constructor
+    AnyVector() = default;
+
+    /// @brief Copy constructor
+    /// @param other The other AnyVector object to be copied
+    AnyVector(const AnyVector &other) : entries(other.entries), nonTrivialCount(other.nonTrivialCount), throwingMoveCount(other.throwingMoveCount)
+    {
+      if (other.used == 0)
+      {
+        return;
+      }
+      buffer = allocate(other.used);
+      capacity = other.used;
+      if (nonTrivialCount == 0)
+      {
+        std::memcpy(buffer, other.buffer, other.used);
+      }
+      else
+      {
+        std::size_t i = 0;
+        try
+        {
+          for (; i < entries.size(); ++i)
+          {
+            entries[i].ops->copy(other.buffer + entries[i].offset, buffer + entries[i].offset);
+          }
+        }
+        catch (...)
+        {
+          destroyRange(0, i);
+          deallocate(buffer);
+          throw;
+        }
+      }
+      used = other.used;
+    }
+
+    /// @brief Move constructor
+    /// @param other The other AnyVector object to be moved
+    AnyVector(AnyVector &&other) noexcept
+        : entries(std::move(other.entries)),
+          buffer(std::exchange(other.buffer, nullptr)),
+          used(std::exchange(other.used, 0)),
+          capacity(std::exchange(other.capacity, 0)),
+          nonTrivialCount(std::exchange(other.nonTrivialCount, 0)),
+          throwingMoveCount(std::exchange(other.throwingMoveCount, 0))
+    {
+      other.entries.clear();
+    }
+
+    /// @brief Destructor
+    ~AnyVector()
+    {
+      clear();
+      deallocate(buffer);
+    }
+
+    /// @brief Copy assignment operator
+    /// @param other The other AnyVector object to be copied
+    /// @return A reference to the current object
+    AnyVector &operator=(const AnyVector &other)
+    {
+      if (this != &other)
+      {
+        *this = AnyVector(other);
+      }
+      return *this;
+    }
+
+    /// @brief Move assignment operator
+    /// @param other The other AnyVector object to be moved
+    /// @return A reference to the current object
+    AnyVector &operator=(AnyVector &&other) noexcept
+    {
+      if (this != &other)
+      {
+        clear();
+        deallocate(buffer);
+        entries = std::move(other.entries);
+        other.entries.clear();
+        buffer = std::exchange(other.buffer, nullptr);
+        used = std::exchange(other.used, 0);
+        capacity = std::exchange(other.capacity, 0);
+        nonTrivialCount = std::exchange(other.nonTrivialCount, 0);
+        throwingMoveCount = std::exchange(other.throwingMoveCount, 0);
+      }
+      return *this;
+    }
+
+    /// @brief Get the number of elements
+    /// @return The number of elements
+    std::size_t size() const
+    {
+      return entries.size();
+    }
+
+    /// @brief Check if the AnyVector object has no element
+    /// @return true if there is no element, false otherwise
+    bool empty() const
+    {
+      return entries.empty();
+    }
+
+    /// @brief Get the number of bytes used by the values
+    /// @return The number of bytes used in the buffer, padding included
+    std::size_t bytes() const
+    {
+      return used;
+    }
+
+    /// @brief Reserve memory for the elements
+    /// @param count The number of elements
+    /// @param byteCount The number of bytes for the values
+    void reserve(std::size_t count, std::size_t byteCount)
+    {
+      entries.reserve(count);
+      if (byteCount > capacity)
+      {
+        reallocate(byteCount);
+      }
+    }
+
+    /// @brief Remove all the elements, the memory is kept
+    void clear()
+    {
+      destroyRange(0, entries.size());
+      entries.clear();
+      used = 0;
+      nonTrivialCount = 0;
+      throwingMoveCount = 0;
+    }
+
+    /// @brief Add a value at the end
+    /// @tparam T The type of the value to be stored
+    /// @param value The value to be stored
+    /// @return A reference to the stored value
+    template <typename T>
+    std::decay_t<T> &pushBack(T &&value)
+    {
+      return emplaceBack<std::decay_t<T>>(std::forward<T>(value));
+    }
+
+    /// @brief Add a value constructed in place at the end
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the stored value
+    template <typename T, typename... Args>
+    std::decay_t<T> &emplaceBack(Args &&...args)
+    {
+      using U = std::decay_t<T>;
+      static_assert(alignof(U) <= alignof(std::max_align_t), "AnyVector: over-aligned types are not supported");
+      static_assert(std::is_copy_constructible<U>::value, "AnyVector: T must be copy constructible");
+
+      std::size_t offset = (used + alignof(U) - 1) & ~(alignof(U) - 1);
+      if (entries.size() == entries.capacity())
+      {
+        entries.reserve(std::max<std::size_t>(8, 2 * entries.capacity())); // the header must not throw once the value is built
+      }
+      U *value = nullptr;
+      if (offset + sizeof(U) > capacity)
+      {
+        // the new value is built before the others are moved, as args may refer to them
+        std::size_t byteCount = std::max(offset + sizeof(U), 2 * capacity);
+        std::byte *fresh = allocate(byteCount);
+        try
+        {
+          value = new (fresh + offset) U(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+          deallocate(fresh);
+          throw;
+        }
+        try
+        {
+          transferTo(fresh);
+        }
+        catch (...)
+        {
+          value->~U();
+          deallocate(fresh);
+          throw;
+        }
+        deallocate(buffer);
+        buffer = fresh;
+        capacity = byteCount;
+      }
+      else
+      {
+        value = new (buffer + offset) U(std::forward<Args>(args)...);
+      }
+      entries.push_back(Entry{&details::AnyVectorHandler<U>::ops, offset});
+      used = offset + sizeof(U);
+      nonTrivialCount += std::is_trivially_copyable<U>::value ? 0 : 1;
+      throwingMoveCount += std::is_nothrow_move_constructible<U>::value ? 0 : 1;
+      return *value;
+    }
+
+    /// @brief Remove the last element
+    void popBack()
+    {
+      const Entry &entry = entries.back();
+      nonTrivialCount -= entry.ops->isTrivial ? 0 : 1;
+      throwingMoveCount -= entry.ops->isNothrowMovable ? 0 : 1;
+      entry.ops->destroy(buffer + entry.offset);
+      used = entry.offset;
+      entries.pop_back();
+    }
+
+    /// @brief Get the identifier of the type of an element
+    /// @param index The index of the element
+    /// @return The identifier of the type of the element
+    TypeId getTypeId(std::size_t index) const
+    {
+      return entries[index].ops->typeId;
+    }
+
+    /// @brief Check if an element is of type T
+    /// @tparam T The type to check
+    /// @param index The index of the element
+    /// @return true if the element is of type T, false otherwise
+    template <typename T>
+    bool holds(std::size_t index) const
+    {
+      return entries[index].ops == &details::AnyVectorHandler<std::decay_t<T>>::ops;
+    }
+
+    /// @brief Get an element
+    /// @tparam T The type of the element
+    /// @param index The index of the element
+    /// @return A pointer to the element, or nullptr if it is not of type T
+    template <typename T>
+    T *getIf(std::size_t index) noexcept
+    {
+      return holds<T>(index) ? std::launder(reinterpret_cast<T *>(buffer + entries[index].offset)) : nullptr;
+    }
+
+    /// @brief Get an element
+    /// @tparam T The type of the element
+    /// @param index The index of the element
+    /// @return A const pointer to the element, or nullptr if it is not of type T
+    template <typename T>
+    const T *getIf(std::size_t index) const noexcept
+    {
+      return holds<T>(index) ? std::launder(reinterpret_cast<const T *>(buffer + entries[index].offset)) : nullptr;
+    }
+
+    /// @brief Get an element
+    /// @tparam T The type of the element
+    /// @param index The index of the element
+    /// @return A reference to the element
+    /// @throw std::bad_cast if the element is not of type T
+    template <typename T>
+    T &get(std::size_t index)
+    {
+      T *value = getIf<T>(index);
+      if (!value)
+      {
+        throw std::bad_cast();
+      }
+      return *value;
+    }
+
+    /// @brief Get an element
+    /// @tparam T The type of the element
+    /// @param index The index of the element
+    /// @return A const reference to the element
+    /// @throw std::bad_cast if the element is not of type T
+    template <typename T>
+    const T &get(std::size_t index) const
+    {
+      const T *value = getIf<T>(index);
+      if (!value)
+      {
+        throw std::bad_cast();
+      }
+      return *value;
+    }
+
+    /// @brief Call a function on every element of type T, in order
+    /// @tparam T The type of the elements
+    /// @tparam F The type of the function
+    /// @param f The function, called with a reference to each element of type T
+    template <typename T, typename F>
+    void forEach(F &&f)
+    {
+      using U = std::decay_t<T>;
+      const details::AnyVectorOps *ops = &details::AnyVectorHandler<U>::ops;
+      for (const Entry &entry : entries)
+      {
+        if (entry.ops == ops)
+        {
+          f(*std::launder(reinterpret_cast<U *>(buffer + entry.offset)));
+        }
+      }
+    }
+
+    /// @brief Call a function on every element of type T, in order
+    /// @tparam T The type of the elements
+    /// @tparam F The type of the function
+    /// @param f The function, called with a const reference to each element of type T
+    template <typename T, typename F>
+    void forEach(F &&f) const
+    {
+      using U = std::decay_t<T>;
+      const details::AnyVectorOps *ops = &details::AnyVectorHandler<U>::ops;
+      for (const Entry &entry : entries)
+      {
+        if (entry.ops == ops)
+        {
+          f(*std::launder(reinterpret_cast<const U *>(buffer + entry.offset)));
+        }
+      }
+    }
+
+  private:
+    /// @brief Allocate a buffer aligned for any type that is not over-aligned
+    /// @param byteCount The size of the buffer
+    /// @return The buffer
+    static std::byte *allocate(std::size_t byteCount)
+    {
+      return static_cast<std::byte *>(::operator new(byteCount));
+    }
+
+    /// @brief Release a buffer
+    /// @param ptr The buffer, may be nullptr
+    static void deallocate(std::byte *ptr) noexcept
+    {
+      ::operator delete(ptr);
+    }
+
+    /// @brief Destroy a range of elements
+    /// @param first The index of the first element
+    /// @param last The index after the last element
+    void destroyRange(std::size_t first, std::size_t last) noexcept
+    {
+      if (nonTrivialCount == 0)
+      {
+        return;
+      }
+      for (std::size_t i = first; i < last; ++i)
+      {
+        entries[i].ops->destroy(buffer + entries[i].offset);
+      }
+    }
+
+    /// @brief Move the values to another buffer, the offsets are kept
+    ///
+    /// If a value can throw when moved, all the values are copied so the
+    /// current buffer is left untouched if a copy throws.
+    /// @param fresh The new buffer, at least as large as the used bytes
+    void transferTo(std::byte *fresh)
+    {
+      if (nonTrivialCount == 0)
+      {
+        if (used > 0)
+        {
+          std::memcpy(fresh, buffer, used);
+        }
+      }
+      else if (throwingMoveCount == 0)
+      {
+        for (const Entry &entry : entries)
+        {
+          entry.ops->relocate(buffer + entry.offset, fresh + entry.offset);
+        }
+      }
+      else
+      {
+        std::size_t i = 0;
+        try
+        {
+          for (; i < entries.size(); ++i)
+          {
+            entries[i].ops->copy(buffer + entries[i].offset, fresh + entries[i].offset);
+          }
+        }
+        catch (...)
+        {
+          for (std::size_t j = 0; j < i; ++j)
+          {
+            entries[j].ops->destroy(fresh + entries[j].offset);
+          }
+          throw;
+        }
+        destroyRange(0, entries.size());
+      }
+    }
+
+    /// @brief Move the values to a bigger buffer
+    /// @param byteCount The size of the new buffer
+    void reallocate(std::size_t byteCount)
+    {
+      std::byte *fresh = allocate(byteCount);
+      try
+      {
+        transferTo(fresh);
+      }
+      catch (...)
+      {
+        deallocate(fresh);
+        throw;
+      }
+      deallocate(buffer);
+      buffer = fresh;
+      capacity = byteCount;
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_ANY_VECTOR_H
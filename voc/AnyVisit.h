@@ -0,0 +1,259 @@
+#ifndef VOC_ANY_VISIT_H
+#define VOC_ANY_VISIT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Any.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Find the index of the type of a value in a list of types
+    ///
+    /// Short lists are searched linearly, longer lists use a hash table built on first use.
+    /// @tparam ...Ts The list of types
+    template <typename... Ts>
+    struct AnyTypeIndex
+    {
+      static constexpr std::size_t Count = sizeof...(Ts);                   ///< The number of types
+      static constexpr std::size_t LinearLimit = 8;                         ///< The longest list searched linearly
+      static constexpr std::array<TypeId, Count> Ids = {voc::typeId<Ts>()...}; ///< The identifiers of the types
+
+      /// @brief Hash table from the identifiers of the types to their index
+      class Table
+      {
+      public:
+        /// @brief Constructor, insert all the types
+        Table()
+        {
+          keys.fill(nullptr);
+          for (std::size_t i = 0; i < Count; ++i)
+          {
+            std::size_t slot = hash(Ids[i]);
+            while (keys[slot] != nullptr)
+            {
+              slot = (slot + 1) & (Size - 1);
+            }
+            keys[slot] = Ids[i];
+            indexes[slot] = i;
+          }
+        }
+
+        /// @brief Find the index of a type
+        /// @param id The identifier of the type
+        /// @return The index of the type, Count if it is not in the list
+        std::size_t find(TypeId id) const noexcept
+        {
+          for (std::size_t slot = hash(id);; slot = (slot + 1) & (Size - 1))
+          {
+            if (keys[slot] == id)
+            {
+              return indexes[slot];
+            }
+            if (keys[slot] == nullptr)
+            {
+              return Count;
+            }
+          }
+        }
+
+      private:
+        /// @brief Compute the number of slots, a power of two at least twice the number of types
+        /// @return The number of slots
+        static constexpr std::size_t slots()
+        {
+          std::size_t size = 1;
+          while (size < 2 * Count)
+          {
+            size *= 2;
+          }
+          return size;
+        }
+
+        static constexpr std::size_t Size = slots(); ///< The number of slots
+
+        /// @brief Hash an identifier
+        /// @param id The identifier
+        /// @return The first slot to look at
+        static std::size_t hash(TypeId id) noexcept
+        {
+          std::uint64_t value = reinterpret_cast<std::uintptr_t>(id);
+          return static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 32) & (Size - 1);
+        }
+
+        std::array<TypeId, Size> keys;          ///< The identifiers, nullptr for an empty slot
+        std::array<std::size_t, Size> indexes{}; ///< The index of each identifier
+      };
+
+      /// @brief Find the index of a type
+      /// @param id The identifier of the type
+      /// @return The index of the type, Count if it is not in the list
+      static std::size_t find(TypeId id) noexcept
+      {
+        if constexpr (Count <= LinearLimit)
+        {
+          for (std::size_t i = 0; i < Count; ++i)
+          {
+            if (Ids[i] == id)
+            {
+              return i;
+            }
+          }
+          return Count;
+        }
+        else
+        {
+          static const Table table;
+          return table.find(id);
+        }
+      }
+    };
+
+    /// @brief Table of the functions calling a visitor on the values of Any objects
+    ///
+    /// Each Any object has Count + 1 possible indexes, the last one being the types not in the list.
+    /// @tparam R The return type of the visitor
+    /// @tparam Visitor The type of the visitor
+    /// @tparam AnyTuple The tuple of references to the Any objects
+    /// @tparam ...Ts The list of types
+    template <typename R, typename Visitor, typename AnyTuple, typename... Ts>
+    struct AnyVisitTable
+    {
+      static constexpr std::size_t Count = sizeof...(Ts);               ///< The number of types
+      static constexpr std::size_t Arity = std::tuple_size<AnyTuple>::value; ///< The number of Any objects
+
+      /// @brief Compute the number of entries of the table
+      /// @return (Count + 1) to the power of Arity
+      static constexpr std::size_t entries()
+      {
+        std::size_t result = 1;
+        for (std::size_t i = 0; i < Arity; ++i)
+        {
+          result *= Count + 1;
+        }
+        return result;
+      }
+
+      /// @brief Get the index of the type of one Any object from an index of the table
+      /// @tparam I The index in the table
+      /// @tparam J The position of the Any object
+      /// @return The index of its type
+      template <std::size_t I, std::size_t J>
+      static constexpr std::size_t typeIndex()
+      {
+        std::size_t index = I;
+        for (std::size_t i = J + 1; i < Arity; ++i)
+        {
+          index /= Count + 1;
+        }
+        return index % (Count + 1);
+      }
+
+      /// @brief Get the argument passed to the visitor for one Any object
+      /// @tparam K The index of its type
+      /// @param any The Any object
+      /// @return A reference to the stored value, or to the Any object if its type is not in the list
+      template <std::size_t K, typename AnyRef>
+      static decltype(auto) argument(AnyRef &any) noexcept
+      {
+        if constexpr (K < Count)
+        {
+          using T = std::tuple_element_t<K, std::tuple<Ts...>>;
+          return AnyAccess::get<T>(any);
+        }
+        else
+        {
+          return any;
+        }
+      }
+
+      /// @brief Call the visitor for one combination of types
+      /// @tparam I The index of the combination in the table
+      template <std::size_t I, std::size_t... J>
+      static R callWith(Visitor &visitor, AnyTuple &anys, std::index_sequence<J...>)
+      {
+        if constexpr (std::is_invocable<Visitor &, decltype(argument<typeIndex<I, J>()>(std::get<J>(anys)))...>::value)
+        {
+          return static_cast<R>(std::invoke(visitor, argument<typeIndex<I, J>()>(std::get<J>(anys))...));
+        }
+        else
+        {
+          throw std::bad_cast(); // a type is not in the list and the visitor does not accept Any objects
+        }
+      }
+
+      /// @brief Call the visitor for one combination of types
+      /// @tparam I The index of the combination in the table
+      template <std::size_t I>
+      static R call(Visitor &visitor, AnyTuple &anys)
+      {
+        return callWith<I>(visitor, anys, std::make_index_sequence<Arity>());
+      }
+
+      /// @brief Build the table
+      template <std::size_t... I>
+      static constexpr std::array<R (*)(Visitor &, AnyTuple &), sizeof...(I)> make(std::index_sequence<I...>)
+      {
+        return {&call<I>...};
+      }
+
+      static constexpr auto Functions = make(std::make_index_sequence<entries()>()); ///< The table
+    };
+
+    /// @brief Visit Any objects
+    template <typename... Ts, typename Visitor, typename... AnyRefs>
+    decltype(auto) visitAnys(Visitor &&visitor, AnyRefs &...anys)
+    {
+      static_assert(sizeof...(Ts) > 0, "visit: the list of types must not be empty");
+      using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+      using R = std::invoke_result_t<Visitor &, std::conditional_t<std::is_const<AnyRefs>::value, const First &, First &>...>;
+      using AnyTuple = std::tuple<AnyRefs &...>;
+      using Table = AnyVisitTable<R, std::remove_reference_t<Visitor>, AnyTuple, Ts...>;
+
+      std::size_t index = 0;
+      ((index = index * (sizeof...(Ts) + 1) + AnyTypeIndex<Ts...>::find(anys.getTypeId())), ...);
+      AnyTuple tuple(anys...);
+      return Table::Functions[index](visitor, tuple);
+    }
+  }
+
+  /// @brief Call a visitor with the value stored in an Any object
+  ///
+  /// The type of the value is found once and the visitor is called through a table of functions.
+  /// If the type is not in the list, the visitor is called with the Any object itself, or
+  /// std::bad_cast is thrown if it does not accept it. The conversion of Any to bool is explicit,
+  /// so a visitor only taking arithmetic values by value does not accept Any objects by mistake.
+  /// @tparam ...Ts The list of the types expected in the Any object
+  /// @param any The Any object
+  /// @param visitor The visitor, called with a reference to the stored value
+  /// @return The result of the visitor
+  template <typename... Ts, typename AnyType, typename Visitor, typename std::enable_if<details::IsBasicAny<std::remove_const_t<AnyType>>::value>::type * = nullptr>
+  decltype(auto) visit(AnyType &any, Visitor &&visitor)
+  {
+    return details::visitAnys<Ts...>(std::forward<Visitor>(visitor), any);
+  }
+
+  /// @brief Call a visitor with the values stored in several Any objects
+  ///
+  /// The table has one function for each combination of types, the last index of each
+  /// Any object being the types that are not in the list.
+  /// @tparam ...Ts The list of the types expected in the Any objects
+  /// @param visitor The visitor, called with a reference to each stored value
+  /// @param ...anys The Any objects
+  /// @return The result of the visitor
+  template <typename... Ts, typename Visitor, typename... AnyTypes, typename std::enable_if<(sizeof...(AnyTypes) >= 2) && (details::IsBasicAny<std::remove_const_t<AnyTypes>>::value && ...)>::type * = nullptr>
+  decltype(auto) visit(Visitor &&visitor, AnyTypes &...anys)
+  {
+    return details::visitAnys<Ts...>(std::forward<Visitor>(visitor), anys...);
+  }
+
+} // namespace voc
+
+#endif // VOC_ANY_VISIT_H
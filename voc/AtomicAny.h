@@ -0,0 +1,302 @@
+#ifndef VOC_ATOMIC_ANY_H
+#define VOC_ATOMIC_ANY_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Any.h"
+#include "SharedAny.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Maximum number of reader counters of an AtomicAny object
+    constexpr std::size_t AtomicAnyMaxStripes = 64;
+
+    /// @brief Reader counters of an AtomicAny object, one cache line per stripe
+    ///
+    /// The readers of the current epoch increment the counter of its parity, so that
+    /// a writer can wait for the readers of the previous epoch while new readers come in.
+    struct alignas(64) AtomicAnyStripe
+    {
+      std::atomic<std::size_t> readers[2] = {}; ///< The number of readers by parity of the epoch
+    };
+
+    /// @brief Get the stripe index of the calling thread, threads are assigned stripes in turn
+    /// @return The index, to be masked by the number of stripes
+    inline std::size_t atomicAnyStripeIndex() noexcept
+    {
+      static std::atomic<std::size_t> next{0};
+      thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+
+    /// @brief Get the number of stripes for this machine, a power of two
+    /// @return The smallest power of two not below the number of hardware threads, at most AtomicAnyMaxStripes
+    inline std::size_t atomicAnyStripeCount() noexcept
+    {
+      std::size_t threads = std::thread::hardware_concurrency();
+      std::size_t count = 1;
+      while (count < threads && count < AtomicAnyMaxStripes)
+      {
+        count <<= 1;
+      }
+      return count;
+    }
+
+    /// @brief Get an empty Any object, returned by the snapshots of an empty AtomicAny object
+    /// @return The empty Any object
+    inline const Any &emptyAny() noexcept
+    {
+      static const Any empty;
+      return empty;
+    }
+  }
+
+  /// @brief Slot holding an immutable value of any type, read and replaced concurrently
+  ///
+  /// It is meant for values read far more often than they are replaced, such as a configuration.
+  /// Readers take a Snapshot with read(): it is wait-free and only writes to a counter of the
+  /// calling thread's stripe, so readers on different cores do not share cache lines. Writers
+  /// publish a new value with store(), then wait until the readers of the previous value have
+  /// released their snapshots before destroying it, as a read-copy-update grace period.
+  ///
+  /// Snapshots should therefore be short-lived. A value can be kept longer with load(), which
+  /// returns a SharedAny object sharing the value through its reference count. A thread must not
+  /// replace the value while it holds a snapshot of the same slot, it would wait for itself.
+  class AtomicAny
+  {
+  private:
+    std::atomic<details::SharedAnyNode *> current{nullptr}; ///< The published value, nullptr if empty
+    std::atomic<std::size_t> epoch{0};                        ///< The epoch, its parity selects the reader counters
+    std::size_t stripeMask;                                    ///< The number of stripes minus one
+    std::unique_ptr<details::AtomicAnyStripe[]> stripes;       ///< The reader counters
+    std::mutex writeMutex;                                     ///< Serializes the writers
+
+    /// @brief Register a reader
+    /// @return The counter to decrement when the reader leaves
+    std::atomic<std::size_t> *enter() const noexcept
+    {
+      details::AtomicAnyStripe &stripe = stripes[details::atomicAnyStripeIndex() & stripeMask];
+      std::atomic<std::size_t> *readers = &stripe.readers[epoch.load(std::memory_order_relaxed) & 1];
+      // Sequentially consistent, so that a writer reading the counter after publishing a value
+      // sees this reader if it loaded the previous value.
+      readers->fetch_add(1, std::memory_order_seq_cst);
+      return readers;
+    }
+
+    /// @brief Wait until the readers of the values published before the last exchange have left
+    void synchronize() noexcept
+    {
+      // Readers may have read the epoch just before it changed, so both parities are drained
+      // in turn, each while new readers register with the other one.
+      for (int round = 0; round < 2; ++round)
+      {
+        std::size_t parity = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+        for (std::size_t i = 0; i <= stripeMask; ++i)
+        {
+          while (stripes[i].readers[parity].load(std::memory_order_seq_cst) != 0)
+          {
+            std::this_thread::yield();
+          }
+        }
+      }
+    }
+
+    /// @brief Release a reference to a node, destroy it if it was the last one
+    /// @param node The node, may be nullptr
+    static void release(details::SharedAnyNode *node) noexcept
+    {
+      if (node && node->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        delete node;
+      }
+    }
+
+  public:
+    /// @brief Read access to the value of an AtomicAny object, valid until the snapshot is destroyed
+    ///
+    /// The value cannot be destroyed by a writer while a snapshot refers to it, so snapshots
+    /// must not be kept longer than needed.
+    class Snapshot
+    {
+    private:
+      std::atomic<std::size_t> *readers = nullptr; ///< The counter of the reader, nullptr if released
+      details::SharedAnyNode *node = nullptr;      ///< The value, nullptr if empty
+
+      friend class AtomicAny;
+
+      /// @brief Constructor, used by AtomicAny::read()
+      /// @param readers The counter of the reader
+      /// @param node The value
+      Snapshot(std::atomic<std::size_t> *readers, details::SharedAnyNode *node) noexcept : readers(readers), node(node) {}
+
+    public:
+      /// @brief Move constructor
+      /// @param other The other snapshot, released
+      Snapshot(Snapshot &&other) noexcept : readers(std::exchange(other.readers, nullptr)), node(std::exchange(other.node, nullptr)) {}
+
+      Snapshot(const Snapshot &) = delete;
+      Snapshot &operator=(const Snapshot &) = delete;
+
+      /// @brief Move assignment operator
+      /// @param other The other snapshot, released
+      /// @return A reference to the current object
+      Snapshot &operator=(Snapshot &&other) noexcept
+      {
+        if (this != &other)
+        {
+          reset();
+          readers = std::exchange(other.readers, nullptr);
+          node = std::exchange(other.node, nullptr);
+        }
+        return *this;
+      }
+
+      /// @brief Destructor, release the snapshot
+      ~Snapshot()
+      {
+        reset();
+      }
+
+      /// @brief Release the snapshot before its destruction, it is then empty
+      void reset() noexcept
+      {
+        if (readers)
+        {
+          readers->fetch_sub(1, std::memory_order_release);
+        }
+        readers = nullptr;
+        node = nullptr;
+      }
+
+      /// @brief Check if the snapshot has a value
+      /// @return true if the value was set when the snapshot was taken, false otherwise
+      bool hasValue() const noexcept
+      {
+        return node != nullptr;
+      }
+
+      /// @brief Conversion operator to bool
+      /// @return true if the snapshot has a value, false otherwise
+      explicit operator bool() const noexcept
+      {
+        return hasValue();
+      }
+
+      /// @brief Get the value
+      /// @return A reference to the value, an empty Any object if the snapshot has no value
+      const Any &operator*() const noexcept
+      {
+        return node ? node->value : details::emptyAny();
+      }
+
+      /// @brief Access the value
+      /// @return A pointer to the value, an empty Any object if the snapshot has no value
+      const Any *operator->() const noexcept
+      {
+        return &**this;
+      }
+    };
+
+    /// @brief Default constructor, no value
+    AtomicAny() : stripeMask(details::atomicAnyStripeCount() - 1), stripes(new details::AtomicAnyStripe[stripeMask + 1]) {}
+
+    /// @brief Constructor from a value
+    /// @param value The initial value, shared with the SharedAny object
+    explicit AtomicAny(SharedAny value) : AtomicAny()
+    {
+      current.store(std::exchange(value.node, nullptr), std::memory_order_relaxed);
+    }
+
+    /// @brief Constructor from an Any object, the value is moved without being copied
+    /// @param value The initial value
+    explicit AtomicAny(Any value) : AtomicAny(SharedAny(std::move(value))) {}
+
+    AtomicAny(const AtomicAny &) = delete;
+    AtomicAny &operator=(const AtomicAny &) = delete;
+
+    /// @brief Destructor, no snapshot may remain
+    ~AtomicAny()
+    {
+      release(current.load(std::memory_order_relaxed));
+    }
+
+    /// @brief Take a snapshot of the value, wait-free
+    /// @return The snapshot
+    Snapshot read() const noexcept
+    {
+      std::atomic<std::size_t> *readers = enter();
+      return Snapshot(readers, current.load(std::memory_order_seq_cst));
+    }
+
+    /// @brief Get the value, shared by reference counting
+    ///
+    /// It can be kept as long as needed, but incrementing the shared reference count does
+    /// not scale with the number of readers as well as read() does.
+    /// @return A SharedAny object sharing the value, empty if there is no value
+    SharedAny load() const noexcept
+    {
+      Snapshot snapshot = read();
+      SharedAny result;
+      if (snapshot.node)
+      {
+        snapshot.node->count.fetch_add(1, std::memory_order_relaxed);
+        result.node = snapshot.node;
+      }
+      return result;
+    }
+
+    /// @brief Replace the value, then wait until the previous value is no longer read
+    /// @param value The new value, shared with the SharedAny object
+    /// @return The previous value, empty if there was no value
+    SharedAny exchange(SharedAny value)
+    {
+      std::lock_guard<std::mutex> lock(writeMutex);
+      SharedAny previous;
+      previous.node = current.exchange(std::exchange(value.node, nullptr), std::memory_order_seq_cst);
+      // The reference of the slot is handed over to the result, so the snapshots must be gone
+      // before the caller can drop it.
+      synchronize();
+      return previous;
+    }
+
+    /// @brief Replace the value, then wait until the previous value is no longer read and destroy it
+    /// @param value The new value, shared with the SharedAny object
+    void store(SharedAny value)
+    {
+      exchange(std::move(value));
+    }
+
+    /// @brief Replace the value by an Any object, moved without being copied
+    /// @param value The new value
+    void store(Any value)
+    {
+      store(SharedAny(std::move(value)));
+    }
+
+    /// @brief Replace the value by a value constructed in place
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename T, typename... Args>
+    void emplace(Args &&...args)
+    {
+      store(SharedAny(InPlaceType<std::decay_t<T>>, std::forward<Args>(args)...));
+    }
+
+    /// @brief Clear the value, then wait until the previous value is no longer read and destroy it
+    void clear()
+    {
+      store(SharedAny());
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_ATOMIC_ANY_H
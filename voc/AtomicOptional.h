@@ -0,0 +1,498 @@
+#ifndef VOC_ATOMIC_OPTIONAL_H
+#define VOC_ATOMIC_OPTIONAL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "Optional.h"
+
+#ifndef VOC_HAS_CAS16
+#if defined(__SIZEOF_INT128__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define VOC_HAS_CAS16 1 // 16 bytes compare and swap instruction, cmpxchg16b on x86-64 built with -mcx16
+#else
+#define VOC_HAS_CAS16 0 // 16 bytes words use a sequence lock unless std::atomic is lock-free for them
+#endif
+#endif
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Encoding of an optional value in Size bytes: the value, then a byte set to 1 if present
+    ///
+    /// All the other bytes are zero, so that two encodings of the same optional value are
+    /// equal byte for byte, unless T has padding bytes.
+    /// @tparam T The type of the value
+    /// @tparam Size The number of bytes, more than sizeof(T)
+    template <typename T, std::size_t Size>
+    struct alignas(Size >= 16 ? 16 : Size) AtomicOptionalBytes
+    {
+      static_assert(sizeof(T) < Size, "AtomicOptionalBytes: no room for the flag");
+
+      unsigned char bytes[Size]; ///< The value and the flag
+
+      /// @brief Encode an optional value
+      /// @param value The optional value
+      /// @return The encoding
+      static AtomicOptionalBytes encode(const Optional<T> &value) noexcept
+      {
+        AtomicOptionalBytes result{};
+        if (value.hasValue())
+        {
+          std::memcpy(result.bytes, &*value, sizeof(T));
+          result.bytes[sizeof(T)] = 1;
+        }
+        return result;
+      }
+
+      /// @brief Decode an optional value
+      /// @return The optional value
+      Optional<T> decode() const noexcept
+      {
+        if (!bytes[sizeof(T)])
+        {
+          return Optional<T>();
+        }
+        Optional<T> result(InPlace);
+        std::memcpy(&*result, bytes, sizeof(T));
+        return result;
+      }
+
+      /// @brief Compare two encodings byte for byte
+      bool operator==(const AtomicOptionalBytes &other) const noexcept
+      {
+        return std::memcmp(bytes, other.bytes, Size) == 0;
+      }
+    };
+
+    /// @brief Wait in a spin loop, yielding to the other threads after a few attempts
+    /// @param spins The number of attempts so far, incremented
+    inline void atomicOptionalBackoff(unsigned &spins) noexcept
+    {
+      if (++spins >= 64)
+      {
+        std::this_thread::yield(); // the writer may have been preempted
+      }
+    }
+
+    /// @brief Get the size of the word packing T and its flag, 0 if there is no lock-free word large enough
+    /// @tparam T The type of the value
+    template <typename T>
+    constexpr std::size_t atomicOptionalWordSize()
+    {
+      if constexpr (sizeof(T) < 8)
+      {
+        return std::atomic<AtomicOptionalBytes<T, 8>>::is_always_lock_free ? 8 : 0;
+      }
+      else if constexpr (sizeof(T) < 16)
+      {
+        return std::atomic<AtomicOptionalBytes<T, 16>>::is_always_lock_free || VOC_HAS_CAS16 ? 16 : 0;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    /// @brief AtomicOptional packing the value and its flag in one lock-free atomic word
+    /// @tparam T The type of the value
+    /// @tparam Size The size of the word, 8 or 16
+    template <typename T, std::size_t Size>
+    class AtomicOptionalPacked
+    {
+    private:
+      using Bytes = AtomicOptionalBytes<T, Size>;
+
+      std::atomic<Bytes> word; ///< The value and its flag
+
+    public:
+      static constexpr bool isLockFree = true; ///< Whether the operations are lock-free
+
+      /// @brief Constructor
+      /// @param value The initial value
+      explicit AtomicOptionalPacked(const Optional<T> &value) noexcept : word(Bytes::encode(value)) {}
+
+      /// @brief Store a value
+      void store(const Optional<T> &value, std::memory_order order) noexcept
+      {
+        word.store(Bytes::encode(value), order);
+      }
+
+      /// @brief Load the value
+      Optional<T> load(std::memory_order order) const noexcept
+      {
+        return word.load(order).decode();
+      }
+
+      /// @brief Replace the value and get the previous one
+      Optional<T> exchange(const Optional<T> &value, std::memory_order order) noexcept
+      {
+        return word.exchange(Bytes::encode(value), order).decode();
+      }
+
+      /// @brief Replace the value if it is equal to expected, otherwise load it in expected
+      bool compareExchange(Optional<T> &expected, const Optional<T> &desired, std::memory_order order) noexcept
+      {
+        Bytes current = Bytes::encode(expected);
+        if (word.compare_exchange_strong(current, Bytes::encode(desired), order, failureOrder(order)))
+        {
+          return true;
+        }
+        expected = current.decode();
+        return false;
+      }
+
+      /// @brief Get the order of the load done by a failed compare exchange
+      static constexpr std::memory_order failureOrder(std::memory_order order) noexcept
+      {
+        return order == std::memory_order_acq_rel ? std::memory_order_acquire : order == std::memory_order_release ? std::memory_order_relaxed : order;
+      }
+    };
+
+#if VOC_HAS_CAS16
+    /// @brief AtomicOptional packing the value and its flag in a 16 bytes word updated by compare and swap
+    ///
+    /// Used where std::atomic is not lock-free for 16 bytes although the instruction exists,
+    /// such as libstdc++ on x86-64. Every operation, loads included, is one compare and swap,
+    /// so loads write the cache line of the word, but no operation ever waits for another thread.
+    /// The builtins are full barriers, stronger than any memory order.
+    /// @tparam T The type of the value
+    template <typename T>
+    class AtomicOptionalWide
+    {
+    private:
+      using Bytes = AtomicOptionalBytes<T, 16>;
+      using Word = unsigned __int128;
+
+      alignas(16) mutable Word word; ///< The value and its flag, only accessed by compare and swap
+
+      /// @brief Convert an encoding to a word
+      static Word pack(const Bytes &bytes) noexcept
+      {
+        Word result;
+        std::memcpy(&result, bytes.bytes, sizeof(result));
+        return result;
+      }
+
+      /// @brief Convert a word to an encoding
+      static Bytes unpack(Word value) noexcept
+      {
+        Bytes result;
+        std::memcpy(result.bytes, &value, sizeof(value));
+        return result;
+      }
+
+      /// @brief Read the word, by a compare and swap that writes back the same value if it matches
+      Word loadWord() const noexcept
+      {
+        return __sync_val_compare_and_swap(&word, Word(0), Word(0));
+      }
+
+      /// @brief Replace the word
+      /// @return The previous word
+      Word exchangeWord(Word desired) noexcept
+      {
+        Word current = loadWord();
+        while (true)
+        {
+          Word previous = __sync_val_compare_and_swap(&word, current, desired);
+          if (previous == current)
+          {
+            return previous;
+          }
+          current = previous;
+        }
+      }
+
+    public:
+      static constexpr bool isLockFree = true; ///< Whether the operations are lock-free
+
+      /// @brief Constructor
+      /// @param value The initial value
+      explicit AtomicOptionalWide(const Optional<T> &value) noexcept : word(pack(Bytes::encode(value))) {}
+
+      /// @brief Store a value
+      void store(const Optional<T> &value, std::memory_order) noexcept
+      {
+        exchangeWord(pack(Bytes::encode(value)));
+      }
+
+      /// @brief Load the value
+      Optional<T> load(std::memory_order) const noexcept
+      {
+        return unpack(loadWord()).decode();
+      }
+
+      /// @brief Replace the value and get the previous one
+      Optional<T> exchange(const Optional<T> &value, std::memory_order) noexcept
+      {
+        return unpack(exchangeWord(pack(Bytes::encode(value)))).decode();
+      }
+
+      /// @brief Replace the value if it is equal to expected, otherwise load it in expected
+      bool compareExchange(Optional<T> &expected, const Optional<T> &desired, std::memory_order) noexcept
+      {
+        Word expectedWord = pack(Bytes::encode(expected));
+        Word previous = __sync_val_compare_and_swap(&word, expectedWord, pack(Bytes::encode(desired)));
+        if (previous == expectedWord)
+        {
+          return true;
+        }
+        expected = unpack(previous).decode();
+        return false;
+      }
+    };
+#endif
+
+    /// @brief AtomicOptional protected by a sequence lock, for values too large for a lock-free word
+    ///
+    /// The encoding is stored in relaxed atomic 64-bit words. Writers make the sequence odd
+    /// while they update the words, and readers retry until they read the same even sequence
+    /// before and after copying the words. Readers never write shared memory, so they do not
+    /// slow each other down, but they spin while a writer is active.
+    /// @tparam T The type of the value
+    template <typename T>
+    class AtomicOptionalSeqLock
+    {
+    private:
+      static constexpr std::size_t Words = (sizeof(T) + 1 + 7) / 8; ///< The number of 64-bit words
+      using Bytes = AtomicOptionalBytes<T, Words * 8>;
+
+      std::atomic<std::uint64_t> sequence{0}; ///< Odd while a writer updates the words
+      std::atomic<std::uint64_t> words[Words]; ///< The encoding of the value
+
+      /// @brief Copy the words, the caller must check the sequence
+      Bytes read() const noexcept
+      {
+        std::uint64_t buffer[Words];
+        for (std::size_t i = 0; i < Words; ++i)
+        {
+          buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        Bytes result;
+        std::memcpy(result.bytes, buffer, sizeof(buffer));
+        return result;
+      }
+
+      /// @brief Overwrite the words, the caller must hold the sequence lock
+      void write(const Bytes &bytes) noexcept
+      {
+        std::uint64_t buffer[Words];
+        std::memcpy(buffer, bytes.bytes, sizeof(buffer));
+        for (std::size_t i = 0; i < Words; ++i)
+        {
+          words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+      }
+
+      /// @brief Make the sequence odd, waiting for the other writers
+      /// @return The even sequence before locking
+      std::uint64_t lock() noexcept
+      {
+        std::uint64_t current = sequence.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while ((current & 1) || !sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          atomicOptionalBackoff(spins);
+          current = sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release); // the words are not written before the sequence is odd
+        return current;
+      }
+
+      /// @brief Make the sequence even again, publishing the words
+      /// @param locked The sequence returned by lock
+      void unlock(std::uint64_t locked) noexcept
+      {
+        sequence.store(locked + 2, std::memory_order_release);
+      }
+
+    public:
+      static constexpr bool isLockFree = false; ///< Whether the operations are lock-free
+
+      /// @brief Constructor
+      /// @param value The initial value
+      explicit AtomicOptionalSeqLock(const Optional<T> &value) noexcept
+      {
+        write(Bytes::encode(value));
+      }
+
+      /// @brief Store a value, the order is at least release
+      void store(const Optional<T> &value, std::memory_order) noexcept
+      {
+        Bytes bytes = Bytes::encode(value);
+        std::uint64_t locked = lock();
+        write(bytes);
+        unlock(locked);
+      }
+
+      /// @brief Load the value, the order is at least acquire
+      Optional<T> load(std::memory_order) const noexcept
+      {
+        for (unsigned spins = 0;; atomicOptionalBackoff(spins))
+        {
+          std::uint64_t before = sequence.load(std::memory_order_acquire);
+          if (before & 1)
+          {
+            continue;
+          }
+          Bytes bytes = read();
+          std::atomic_thread_fence(std::memory_order_acquire); // the words are read before the sequence
+          if (sequence.load(std::memory_order_relaxed) == before)
+          {
+            return bytes.decode();
+          }
+        }
+      }
+
+      /// @brief Replace the value and get the previous one, the order is acq_rel
+      Optional<T> exchange(const Optional<T> &value, std::memory_order) noexcept
+      {
+        Bytes bytes = Bytes::encode(value);
+        std::uint64_t locked = lock();
+        Bytes previous = read();
+        write(bytes);
+        unlock(locked);
+        return previous.decode();
+      }
+
+      /// @brief Replace the value if it is equal to expected, otherwise load it in expected, the order is acq_rel
+      bool compareExchange(Optional<T> &expected, const Optional<T> &desired, std::memory_order) noexcept
+      {
+        Bytes expectedBytes = Bytes::encode(expected);
+        Bytes desiredBytes = Bytes::encode(desired);
+        std::uint64_t locked = lock();
+        Bytes current = read();
+        bool equal = current == expectedBytes;
+        if (equal)
+        {
+          write(desiredBytes);
+        }
+        unlock(locked);
+        if (!equal)
+        {
+          expected = current.decode();
+        }
+        return equal;
+      }
+    };
+
+    /// @brief Implementation of AtomicOptional for T
+    template <typename T, std::size_t WordSize = atomicOptionalWordSize<T>()>
+    struct AtomicOptionalImpl
+    {
+      using type = AtomicOptionalPacked<T, WordSize>;
+    };
+
+    template <typename T>
+    struct AtomicOptionalImpl<T, 0>
+    {
+      using type = AtomicOptionalSeqLock<T>;
+    };
+
+#if VOC_HAS_CAS16
+    template <typename T>
+    struct AtomicOptionalImpl<T, 16>
+    {
+      using type = std::conditional_t<std::atomic<AtomicOptionalBytes<T, 16>>::is_always_lock_free, AtomicOptionalPacked<T, 16>, AtomicOptionalWide<T>>;
+    };
+#endif
+  }
+
+  /// @brief Optional value shared between threads, for trivially copyable types
+  ///
+  /// If the value and a flag fit in a lock-free atomic word of 8 or 16 bytes, all the operations
+  /// are lock-free atomic instructions. The 16 bytes word uses the compare and swap instruction
+  /// directly when std::atomic is not lock-free for it (VOC_HAS_CAS16, -mcx16 on x86-64), so
+  /// values of 8 bytes such as double stay lock-free. Otherwise a sequence lock is used: loads do not write
+  /// shared memory but retry while a store is in progress, and stores exclude each other.
+  /// Values are compared byte for byte by compareExchange, like std::atomic does, so types
+  /// with padding bytes may fail to compare equal.
+  /// @tparam T The type of the value, trivially copyable and default constructible
+  template <typename T>
+  class AtomicOptional
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "AtomicOptional: T must be trivially copyable");
+    static_assert(std::is_default_constructible<T>::value, "AtomicOptional: T must be default constructible");
+
+  private:
+    using Impl = typename details::AtomicOptionalImpl<T>::type;
+
+    Impl impl; ///< The value, packed in a word or protected by a sequence lock
+
+  public:
+    /// @brief Whether the operations are lock-free for T
+    static constexpr bool isAlwaysLockFree = Impl::isLockFree;
+
+    /// @brief Default constructor, no value
+    AtomicOptional() noexcept : impl(Optional<T>()) {}
+
+    /// @brief Constructor from an optional value
+    /// @param value The initial value
+    AtomicOptional(const Optional<T> &value) noexcept : impl(value) {}
+
+    /// @brief Constructor from a value
+    /// @param value The initial value
+    AtomicOptional(const T &value) noexcept : impl(Optional<T>(value)) {}
+
+    AtomicOptional(const AtomicOptional &) = delete;
+    AtomicOptional &operator=(const AtomicOptional &) = delete;
+
+    /// @brief Store a value
+    /// @param value The value, no value to clear the object
+    /// @param order The memory order
+    void store(const Optional<T> &value, std::memory_order order = std::memory_order_release) noexcept
+    {
+      impl.store(value, order);
+    }
+
+    /// @brief Load the value
+    /// @param order The memory order
+    /// @return A copy of the value, no value if the object is empty
+    Optional<T> load(std::memory_order order = std::memory_order_acquire) const noexcept
+    {
+      return impl.load(order);
+    }
+
+    /// @brief Replace the value
+    /// @param value The new value
+    /// @param order The memory order
+    /// @return The previous value
+    Optional<T> exchange(const Optional<T> &value, std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+      return impl.exchange(value, order);
+    }
+
+    /// @brief Take the value, leaving the object empty
+    /// @param order The memory order
+    /// @return The value, no value if the object was empty
+    Optional<T> take(std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+      return impl.exchange(Optional<T>(), order);
+    }
+
+    /// @brief Replace the value if it is equal to an expected value
+    /// @param expected The expected value, replaced by the current value if they are different
+    /// @param desired The new value
+    /// @param order The memory order
+    /// @return true if the value was replaced, false otherwise
+    bool compareExchange(Optional<T> &expected, const Optional<T> &desired, std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+      return impl.compareExchange(expected, desired, order);
+    }
+
+    /// @brief Clear the value
+    /// @param order The memory order
+    void clear(std::memory_order order = std::memory_order_release) noexcept
+    {
+      impl.store(Optional<T>(), order);
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_ATOMIC_OPTIONAL_H
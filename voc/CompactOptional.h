@@ -0,0 +1,233 @@
+#ifndef VOC_COMPACT_OPTIONAL_H
+#define VOC_COMPACT_OPTIONAL_H
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Optional.h"
+
+namespace voc
+{
+  /// @brief Policy encoding the empty state in a sentinel value
+  /// @tparam T The type of the value
+  /// @tparam Sentinel The value meaning "no value"
+  template <typename T, T Sentinel>
+  struct SentinelPolicy
+  {
+    /// @brief Get the value stored when there is no value
+    /// @return The sentinel
+    static constexpr T empty() noexcept
+    {
+      return Sentinel;
+    }
+
+    /// @brief Check if a stored value means "no value"
+    /// @param value The stored value
+    /// @return true if the value is the sentinel, false otherwise
+    static constexpr bool isEmpty(const T &value) noexcept
+    {
+      return value == Sentinel;
+    }
+  };
+
+  /// @brief Policy encoding the empty state in a NaN, for floating point types
+  /// @tparam T The floating point type
+  template <typename T>
+  struct NaNPolicy
+  {
+    static_assert(std::numeric_limits<T>::has_quiet_NaN, "NaNPolicy: T must have a quiet NaN");
+
+    /// @brief Get the value stored when there is no value
+    /// @return A quiet NaN
+    static constexpr T empty() noexcept
+    {
+      return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    /// @brief Check if a stored value means "no value"
+    /// @param value The stored value
+    /// @return true if the value is a NaN, false otherwise
+    static constexpr bool isEmpty(const T &value) noexcept
+    {
+      return value != value;
+    }
+  };
+
+  /// @brief Policy encoding the empty state in a null pointer
+  /// @tparam T The pointer type
+  template <typename T>
+  struct NullPolicy
+  {
+    /// @brief Get the value stored when there is no value
+    /// @return A null pointer
+    static constexpr T empty() noexcept
+    {
+      return nullptr;
+    }
+
+    /// @brief Check if a stored value means "no value"
+    /// @param value The stored value
+    /// @return true if the value is a null pointer, false otherwise
+    static constexpr bool isEmpty(const T &value) noexcept
+    {
+      return value == nullptr;
+    }
+  };
+
+  namespace details
+  {
+    /// @brief Default policy of CompactOptional, NaN for floating point types and nullptr for pointers
+    template <typename T, typename = void>
+    struct CompactOptionalDefaultPolicy
+    {
+      static_assert(std::is_floating_point<T>::value || std::is_pointer<T>::value, "CompactOptional: T has no unused value, a policy must be given");
+    };
+
+    template <typename T>
+    struct CompactOptionalDefaultPolicy<T, std::enable_if_t<std::is_floating_point<T>::value>> : NaNPolicy<T>
+    {
+    };
+
+    template <typename T>
+    struct CompactOptionalDefaultPolicy<T, std::enable_if_t<std::is_pointer<T>::value>> : NullPolicy<T>
+    {
+    };
+  }
+
+  /// @brief Class to store a value or no value, in exactly sizeof(T) bytes
+  ///
+  /// There is no flag: the empty state is encoded in an unused value of T given by the policy,
+  /// so storing that value makes the CompactOptional object empty. The policy provides
+  /// `static constexpr T empty()` and `static constexpr bool isEmpty(const T &)`.
+  /// @tparam T The type of the value
+  /// @tparam Policy The policy, NaN for floating point types and nullptr for pointers by default
+  template <typename T, typename Policy = details::CompactOptionalDefaultPolicy<T>>
+  class CompactOptional
+  {
+  public:
+    /// @brief Default constructor
+    constexpr CompactOptional() : value(Policy::empty()) {}
+
+    /// @brief Constructor from a value
+    /// @param value The value to be stored
+    constexpr CompactOptional(const T &value) : value(value) {}
+
+    /// @brief Constructor from a rvalue
+    /// @param value The value to be stored
+    constexpr CompactOptional(T &&value) : value(std::move(value)) {}
+
+    /// @brief Constructor for in-place construction
+    /// @tparam Args The types of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename... Args>
+    constexpr CompactOptional(InPlaceStruct, Args &&...args) : value(std::forward<Args>(args)...) {}
+
+    /// @brief Check if the CompactOptional object has a value
+    /// @return true if the CompactOptional object has a value, false otherwise
+    constexpr bool hasValue() const
+    {
+      return !Policy::isEmpty(value);
+    }
+
+    /// @brief Conversion operator to bool
+    /// @return true if the CompactOptional object has a value, false otherwise
+    constexpr explicit operator bool() const
+    {
+      return hasValue();
+    }
+
+    /// @brief Get the stored value
+    /// @return The stored value
+    constexpr T &getValue()
+    {
+      if (!hasValue())
+        throw std::runtime_error("CompactOptional has no value");
+      return value;
+    }
+
+    /// @brief Get the stored value
+    /// @return The stored value
+    constexpr const T &getValue() const
+    {
+      if (!hasValue())
+        throw std::runtime_error("CompactOptional has no value");
+      return value;
+    }
+
+    /// @brief Get the stored value or a default value
+    /// @tparam U The type of the default value
+    /// @param defaultValue The default value
+    /// @return The stored value if it exists, otherwise the default value
+    template <typename U>
+    constexpr T getValueOr(U &&defaultValue) const
+    {
+      return hasValue() ? value : static_cast<T>(std::forward<U>(defaultValue));
+    }
+
+    /// @brief Clear the CompactOptional object
+    constexpr void clear()
+    {
+      value = Policy::empty();
+    }
+
+    /// @brief Replace the stored value by a value constructed in place
+    /// @tparam Args The types of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the new stored value
+    template <typename... Args>
+    constexpr T &emplace(Args &&...args)
+    {
+      value = T(std::forward<Args>(args)...);
+      return value;
+    }
+
+    /// @brief Dereference operator
+    /// @return A reference to the stored value
+    constexpr T &operator*()
+    {
+      return value;
+    }
+
+    /// @brief Dereference operator
+    /// @return A const reference to the stored value
+    constexpr const T &operator*() const
+    {
+      return value;
+    }
+
+    /// @brief Arrow operator
+    /// @return A pointer to the stored value
+    constexpr T *operator->()
+    {
+      return std::addressof(value);
+    }
+
+    /// @brief Arrow operator
+    /// @return A const pointer to the stored value
+    constexpr const T *operator->() const
+    {
+      return std::addressof(value);
+    }
+
+  private:
+    T value; ///< The stored value, or the empty value of the policy
+  };
+
+  /// @brief Create a CompactOptional object from a value
+  /// @tparam T The type of the value to be stored
+  /// @tparam Policy The policy encoding the empty state
+  /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+  /// @param ...args The arguments to be passed to the constructor of T
+  /// @return A CompactOptional object storing the value
+  template <typename T, typename Policy = details::CompactOptionalDefaultPolicy<T>, typename... Args>
+  constexpr CompactOptional<T, Policy> makeCompactOptional(Args &&...args)
+  {
+    return CompactOptional<T, Policy>(InPlace, std::forward<Args>(args)...);
+  }
+
+} // namespace voc
+
+#endif // VOC_COMPACT_OPTIONAL_H
@@ -1,9 +1,12 @@
 #ifndef VOC_OPTIONAL_H
 #define VOC_OPTIONAL_H
 
+#include <functional>
 #include <typeinfo>
 #include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 namespace voc
@@ -17,198 +20,677 @@ namespace voc
   /// @brief Constant for in-place construction of Optional
   inline constexpr InPlaceStruct InPlace = {};
 
-  /// @brief Class to store a value or no value
   template <typename T>
-  class Optional
-  {
-  public:
-    /// @brief Default constructor
-    Optional() : initialized(false) {}
+  class Optional;
 
-    /// @brief Constructor from a value
-    /// @param value The value to be stored
-    Optional(const T &value) : initialized(true)
+  namespace details
+  {
+    /// @brief Struct for the construction of the value of Optional from the result of a function
+    struct OptionalInvokeStruct
     {
-      new (&data) T(value);
-    }
+    };
 
-    /// @brief Constructor from a rvalue
-    /// @param value The value to be stored
-    Optional(T &&value) : initialized(true)
+    /// @brief Check if a type is an Optional
+    template <typename T>
+    struct IsOptional : std::false_type
     {
-      new (&data) T(std::move(value));
-    }
+    };
 
-    /// @brief Constructor for in-place construction
-    /// @tparam Args The types of the arguments to be passed to the constructor of T
-    /// @param ...args The arguments to be passed to the constructor of T
-    template <typename... Args>
-    Optional(InPlaceStruct, Args &&...args) : initialized(true)
+    template <typename T>
+    struct IsOptional<Optional<T>> : std::true_type
     {
-      new (&data) T(std::forward<Args>(args)...);
-    }
+    };
 
-    /// @brief Copy constructor
-    /// @param other The other Optional object to be copied
-    Optional(const Optional &other) : initialized(other.initialized)
+    /// @brief Storage of Optional, the value in a union and a flag
+    ///
+    /// The destructor is trivial if the destructor of T is trivial. The value is stored
+    /// without const, so that Optional<const T> can still be assigned and emplaced.
+    /// @tparam T The type of the value
+    template <typename T, bool = std::is_trivially_destructible<T>::value>
+    struct OptionalStorage
     {
-      if (other.initialized)
+      using Stored = std::remove_const_t<T>; ///< The type of the stored value
+
+      /// @brief Default constructor, no value
+      constexpr OptionalStorage() noexcept : empty() {}
+
+      /// @brief Constructor of the value
+      /// @tparam ...Args The types of the arguments to be passed to the constructor of T
+      /// @param ...args The arguments to be passed to the constructor of T
+      template <typename... Args>
+      constexpr explicit OptionalStorage(InPlaceStruct, Args &&...args) : value(std::forward<Args>(args)...), initialized(true) {}
+
+      /// @brief Constructor of the value from the result of a function, without intermediate copy
+      /// @param f The function
+      /// @param arg The argument of the function
+      template <typename F, typename Arg>
+      OptionalStorage(OptionalInvokeStruct, F &&f, Arg &&arg) : value(std::invoke(std::forward<F>(f), std::forward<Arg>(arg))), initialized(true) {}
+
+      /// @brief Destructor
+      ~OptionalStorage()
       {
-        new (&data) T(*other.ptr());
+        clear();
       }
-    }
 
-    /// @brief Move constructor
-    /// @param other The other Optional object to be moved
-    Optional(Optional &&other) noexcept : initialized(other.initialized)
+      /// @brief Construct the value, there must be no value
+      /// @tparam ...Args The types of the arguments to be passed to the constructor of T
+      /// @param ...args The arguments to be passed to the constructor of T
+      template <typename... Args>
+      void construct(Args &&...args)
+      {
+        new (&value) Stored(std::forward<Args>(args)...);
+        initialized = true;
+      }
+
+      /// @brief Destroy the value if there is one
+      void clear()
+      {
+        if (initialized)
+        {
+          value.~Stored(); // Call the destructor explicitly
+          initialized = false;
+        }
+      }
+
+      union
+      {
+        char empty;   ///< Active member when there is no value
+        Stored value; ///< The stored value
+      };
+      bool initialized = false; ///< Whether there is a value
+    };
+
+    template <typename T>
+    struct OptionalStorage<T, true>
     {
-      if (other.initialized)
+      using Stored = std::remove_const_t<T>; ///< The type of the stored value
+
+      /// @brief Default constructor, no value
+      constexpr OptionalStorage() noexcept : empty() {}
+
+      /// @brief Constructor of the value
+      /// @tparam ...Args The types of the arguments to be passed to the constructor of T
+      /// @param ...args The arguments to be passed to the constructor of T
+      template <typename... Args>
+      constexpr explicit OptionalStorage(InPlaceStruct, Args &&...args) : value(std::forward<Args>(args)...), initialized(true) {}
+
+      /// @brief Constructor of the value from the result of a function, without intermediate copy
+      /// @param f The function
+      /// @param arg The argument of the function
+      template <typename F, typename Arg>
+      OptionalStorage(OptionalInvokeStruct, F &&f, Arg &&arg) : value(std::invoke(std::forward<F>(f), std::forward<Arg>(arg))), initialized(true) {}
+
+      /// @brief Construct the value, there must be no value
+      /// @tparam ...Args The types of the arguments to be passed to the constructor of T
+      /// @param ...args The arguments to be passed to the constructor of T
+      template <typename... Args>
+      void construct(Args &&...args)
       {
-        new (&data) T(std::move(*other.ptr()));
-        other.clear(); // Ensure the moved-from object is in a valid state
+        new (&value) Stored(std::forward<Args>(args)...);
+        initialized = true;
       }
-    }
 
-    /// @brief Destructor
-    ~Optional()
+      /// @brief Forget the value, it has nothing to destroy
+      void clear()
+      {
+        initialized = false;
+      }
+
+      union
+      {
+        char empty;   ///< Active member when there is no value
+        Stored value; ///< The stored value
+      };
+      bool initialized = false; ///< Whether there is a value
+    };
+
+    /// @brief Copy and move operations of Optional
+    ///
+    /// If T is trivially copyable, they are all defaulted and trivial, so that Optional<T>
+    /// is trivially copyable too and can be copied with memcpy.
+    /// @tparam T The type of the value
+    template <typename T, bool = std::is_trivially_copyable<T>::value>
+    struct OptionalOperations : OptionalStorage<T>
     {
-      clear();
-    }
+      using OptionalStorage<T>::OptionalStorage;
+    };
 
-    /// @brief Copy assignment operator
-    /// @param other The other Optional object to be copied
-    /// @return A reference to the current object
-    Optional &operator=(const Optional &other)
+    template <typename T>
+    struct OptionalOperations<T, false> : OptionalStorage<T>
     {
-      if (this != &other)
+      using OptionalStorage<T>::OptionalStorage;
+
+      /// @brief Default constructor, no value
+      OptionalOperations() = default;
+
+      /// @brief Copy constructor
+      /// @param other The other object to be copied
+      OptionalOperations(const OptionalOperations &other) : OptionalStorage<T>()
       {
-        if (initialized)
-          clear();
         if (other.initialized)
         {
-          new (&data) T(*other.ptr());
-          initialized = true;
+          this->construct(other.value);
         }
       }
-      return *this;
-    }
 
-    /// @brief Move assignment operator
-    /// @param other The other Optional object to be moved
-    /// @return A reference to the current object
-    Optional &operator=(Optional &&other) noexcept
-    {
-      if (this != &other)
+      /// @brief Move constructor, the other object is left without value
+      /// @param other The other object to be moved
+      OptionalOperations(OptionalOperations &&other) noexcept : OptionalStorage<T>()
       {
-        if (initialized)
-          clear();
         if (other.initialized)
         {
-          new (&data) T(std::move(*other.ptr()));
-          initialized = true;
+          this->construct(std::move(other.value));
           other.clear(); // Ensure the moved-from object is in a valid state
         }
       }
-      return *this;
-    }
+
+      /// @brief Copy assignment operator
+      /// @param other The other object to be copied
+      /// @return A reference to the current object
+      OptionalOperations &operator=(const OptionalOperations &other)
+      {
+        if (this != &other)
+        {
+          this->clear();
+          if (other.initialized)
+          {
+            this->construct(other.value);
+          }
+        }
+        return *this;
+      }
+
+      /// @brief Move assignment operator, the other object is left without value
+      /// @param other The other object to be moved
+      /// @return A reference to the current object
+      OptionalOperations &operator=(OptionalOperations &&other) noexcept
+      {
+        if (this != &other)
+        {
+          this->clear();
+          if (other.initialized)
+          {
+            this->construct(std::move(other.value));
+            other.clear(); // Ensure the moved-from object is in a valid state
+          }
+        }
+        return *this;
+      }
+    };
+  }
+
+  /// @brief Class to store a value or no value
+  ///
+  /// Optional<T> is trivially copyable and trivially destructible whenever T is.
+  /// A moved-from Optional of a trivially copyable type keeps its value.
+  /// For literal types, Optional can be built and read in constant expressions.
+  template <typename T>
+  class Optional : private details::OptionalOperations<T>
+  {
+  public:
+    /// @brief Default constructor
+    constexpr Optional() = default;
+
+    /// @brief Constructor from a value
+    /// @param value The value to be stored
+    constexpr Optional(const T &value) : details::OptionalOperations<T>(InPlace, value) {}
+
+    /// @brief Constructor from a rvalue
+    /// @param value The value to be stored
+    constexpr Optional(T &&value) : details::OptionalOperations<T>(InPlace, std::move(value)) {}
+
+    /// @brief Constructor for in-place construction
+    /// @tparam Args The types of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename... Args>
+    constexpr Optional(InPlaceStruct, Args &&...args) : details::OptionalOperations<T>(InPlace, std::forward<Args>(args)...) {}
 
     /// @brief Check if the Optional object has a value
     /// @return true if the Optional object has a value, false otherwise
-    bool hasValue() const
+    constexpr bool hasValue() const
     {
-      return initialized;
+      return this->initialized;
     }
 
     /// @brief Conversion operator to bool
     /// @return true if the Optional object has a value, false otherwise
-    explicit operator bool() const
+    constexpr explicit operator bool() const
     {
       return hasValue();
     }
 
     /// @brief Get the stored value
     /// @return The stored value
-    T &getValue()
+    constexpr T &getValue()
     {
-      if (!initialized)
+      if (!this->initialized)
         throw std::runtime_error("Optional has no value");
       return *ptr();
     }
 
     /// @brief Get the stored value
     /// @return The stored value
-    const T &getValue() const
+    constexpr const T &getValue() const
     {
-      if (!initialized)
+      if (!this->initialized)
         throw std::runtime_error("Optional has no value");
       return *ptr();
     }
 
     /// @brief Get the stored value or a default value
+    ///
+    /// If the default value is an lvalue of type T, a reference to one of the values is returned
+    /// instead of a copy, it is valid as long as both the Optional object and the default value.
     /// @tparam U The type of the default value
     /// @param defaultValue The default value
     /// @return The stored value if it exists, otherwise the default value
     template <typename U>
-    T getValueOr(U &&defaultValue) const
+    constexpr std::conditional_t<std::is_lvalue_reference<U>::value && std::is_same<std::remove_cv_t<std::remove_reference_t<U>>, T>::value, const T &, T> getValueOr(U &&defaultValue) const &
     {
-      return initialized ? *ptr() : static_cast<T>(std::forward<U>(defaultValue));
+      if constexpr (std::is_lvalue_reference<U>::value && std::is_same<std::remove_cv_t<std::remove_reference_t<U>>, T>::value)
+      {
+        return this->initialized ? *ptr() : defaultValue;
+      }
+      else
+      {
+        return this->initialized ? *ptr() : static_cast<T>(std::forward<U>(defaultValue));
+      }
+    }
+
+    /// @brief Get the stored value or a default value, the stored value is moved out
+    /// @tparam U The type of the default value
+    /// @param defaultValue The default value
+    /// @return The stored value if it exists, otherwise the default value
+    template <typename U>
+    constexpr T getValueOr(U &&defaultValue) &&
+    {
+      return this->initialized ? std::move(*ptr()) : static_cast<T>(std::forward<U>(defaultValue));
+    }
+
+    /// @brief Get the stored value or the result of a function, called only if there is no value
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument
+    /// @return The stored value if it exists, otherwise the result of f
+    template <typename F>
+    T getValueOrElse(F &&f) const &
+    {
+      return this->initialized ? *ptr() : static_cast<T>(std::invoke(std::forward<F>(f)));
+    }
+
+    /// @brief Get the stored value or the result of a function, the stored value is moved out
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument
+    /// @return The stored value if it exists, otherwise the result of f
+    template <typename F>
+    T getValueOrElse(F &&f) &&
+    {
+      return this->initialized ? std::move(*ptr()) : static_cast<T>(std::invoke(std::forward<F>(f)));
+    }
+
+    /// @brief Apply a function to the stored value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return An Optional object storing the result of f, or no value if there is no stored value
+    template <typename F>
+    auto transform(F &&f) &
+    {
+      return transformWith(std::forward<F>(f), *this);
+    }
+
+    /// @brief Apply a function to the stored value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return An Optional object storing the result of f, or no value if there is no stored value
+    template <typename F>
+    auto transform(F &&f) const &
+    {
+      return transformWith(std::forward<F>(f), *this);
+    }
+
+    /// @brief Apply a function to the stored value, which is passed as an rvalue
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return An Optional object storing the result of f, or no value if there is no stored value
+    template <typename F>
+    auto transform(F &&f) &&
+    {
+      return transformWith(std::forward<F>(f), std::move(*this));
+    }
+
+    /// @brief Apply a function returning an Optional object to the stored value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return The result of f, or no value if there is no stored value
+    template <typename F>
+    auto andThen(F &&f) &
+    {
+      return andThenWith(std::forward<F>(f), *this);
+    }
+
+    /// @brief Apply a function returning an Optional object to the stored value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return The result of f, or no value if there is no stored value
+    template <typename F>
+    auto andThen(F &&f) const &
+    {
+      return andThenWith(std::forward<F>(f), *this);
+    }
+
+    /// @brief Apply a function returning an Optional object to the stored value, which is passed as an rvalue
+    /// @tparam F The type of the function
+    /// @param f The function, called with the stored value
+    /// @return The result of f, or no value if there is no stored value
+    template <typename F>
+    auto andThen(F &&f) &&
+    {
+      return andThenWith(std::forward<F>(f), std::move(*this));
+    }
+
+    /// @brief Get the Optional object, or the result of a function if there is no value
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument, returning an Optional<T>
+    /// @return A copy of the Optional object if it has a value, otherwise the result of f
+    template <typename F>
+    Optional orElse(F &&f) const &
+    {
+      static_assert(std::is_same<std::decay_t<std::invoke_result_t<F>>, Optional>::value, "orElse: the function must return an Optional<T>");
+      return this->initialized ? *this : std::invoke(std::forward<F>(f));
+    }
+
+    /// @brief Get the Optional object, or the result of a function if there is no value
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument, returning an Optional<T>
+    /// @return The Optional object moved if it has a value, otherwise the result of f
+    template <typename F>
+    Optional orElse(F &&f) &&
+    {
+      static_assert(std::is_same<std::decay_t<std::invoke_result_t<F>>, Optional>::value, "orElse: the function must return an Optional<T>");
+      return this->initialized ? std::move(*this) : std::invoke(std::forward<F>(f));
     }
 
     /// @brief Clear the Optional object
     void clear()
     {
-      if (initialized)
-      {
-        ptr()->~T(); // Call the destructor explicitly
-        initialized = false;
-      }
+      details::OptionalStorage<T>::clear();
+    }
+
+    /// @brief Replace the stored value by a value constructed in place
+    /// @tparam Args The types of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the new stored value
+    template <typename... Args>
+    T &emplace(Args &&...args)
+    {
+      clear();
+      this->construct(std::forward<Args>(args)...);
+      return *ptr();
     }
 
     /// @brief Dereference operator
     /// @return A reference to the stored value
-    T &operator*()
+    constexpr T &operator*()
     {
       return *ptr();
     }
 
     /// @brief Dereference operator
     /// @return A const reference to the stored value
-    const T &operator*() const
+    constexpr const T &operator*() const
     {
       return *ptr();
     }
 
     /// @brief Arrow operator
     /// @return A pointer to the stored value
-    T *operator->()
+    constexpr T *operator->()
     {
       return ptr();
     }
 
     /// @brief Arrow operator
     /// @return A const pointer to the stored value
-    const T *operator->() const
+    constexpr const T *operator->() const
     {
       return ptr();
     }
 
   private:
-    alignas(T) mutable char data[sizeof(T)]; ///< The stored value
-    bool initialized = false; ///< Whether the Optional object has a value
+    template <typename U>
+    friend class Optional;
+
+    /// @brief Constructor from the result of a function, without intermediate copy
+    /// @param f The function
+    /// @param arg The argument of the function
+    template <typename F, typename Arg>
+    Optional(details::OptionalInvokeStruct tag, F &&f, Arg &&arg) : details::OptionalOperations<T>(tag, std::forward<F>(f), std::forward<Arg>(arg)) {}
+
+    /// @brief Get the stored value with the value category of the Optional object and the constness of T
+    /// @param self The Optional object, with its value category
+    /// @return A reference to the stored value, an rvalue reference if the object is an rvalue
+    template <typename Self>
+    static constexpr decltype(auto) forwardValue(Self &&self)
+    {
+      if constexpr (std::is_lvalue_reference<Self>::value)
+      {
+        return *self.ptr();
+      }
+      else
+      {
+        return std::move(*self.ptr());
+      }
+    }
+
+    /// @brief Implementation of transform
+    /// @param f The function
+    /// @param self The Optional object, with its value category
+    /// @return An Optional object storing the result of f, or no value
+    template <typename F, typename Self>
+    static auto transformWith(F &&f, Self &&self)
+    {
+      using U = std::remove_cv_t<std::invoke_result_t<F, decltype(forwardValue(std::forward<Self>(self)))>>;
+      static_assert(!std::is_void<U>::value && !std::is_reference<U>::value, "transform: the function must return a value");
+      if (!self.initialized)
+      {
+        return Optional<U>();
+      }
+      return Optional<U>(details::OptionalInvokeStruct(), std::forward<F>(f), forwardValue(std::forward<Self>(self)));
+    }
+
+    /// @brief Implementation of andThen
+    /// @param f The function
+    /// @param self The Optional object, with its value category
+    /// @return The result of f, or no value
+    template <typename F, typename Self>
+    static auto andThenWith(F &&f, Self &&self)
+    {
+      using R = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, decltype(forwardValue(std::forward<Self>(self)))>>>;
+      static_assert(details::IsOptional<R>::value, "andThen: the function must return an Optional");
+      if (!self.initialized)
+      {
+        return R();
+      }
+      return R(std::invoke(std::forward<F>(f), forwardValue(std::forward<Self>(self))));
+    }
 
     /// @brief Get a pointer to the stored value
     /// @return A pointer to the stored value
-    T *ptr()
+    constexpr T *ptr()
     {
-      return reinterpret_cast<T *>(&data);
+      return std::addressof(this->value);
     }
 
     /// @brief Get a const pointer to the stored value
     /// @return A const pointer to the stored value
-    const T *ptr() const
+    constexpr const T *ptr() const
+    {
+      return std::addressof(this->value);
+    }
+  };
+
+  /// @brief Optional reference, stored as a single pointer
+  ///
+  /// Assignment rebinds the reference, it never assigns through it.
+  /// @tparam T The type of the referenced value
+  template <typename T>
+  class Optional<T &>
+  {
+  public:
+    /// @brief Default constructor, no reference
+    constexpr Optional() noexcept = default;
+
+    /// @brief Constructor from a reference
+    /// @param value The referenced value
+    constexpr Optional(T &value) noexcept : pointer(std::addressof(value)) {}
+
+    /// @brief Deleted constructor from a temporary, the reference would dangle
+    Optional(std::remove_const_t<T> &&) = delete;
+
+    /// @brief Conversion from another Optional reference, for example Optional<int &> to Optional<const int &>
+    /// @tparam U The type of the other referenced value
+    /// @param other The other Optional reference
+    template <typename U, typename std::enable_if<!std::is_same<U, T>::value && std::is_convertible<U *, T *>::value>::type * = nullptr>
+    constexpr Optional(const Optional<U &> &other) noexcept : pointer(other.operator->()) {}
+
+    /// @brief Rebind to another value
+    /// @param value The new referenced value
+    /// @return A reference to the current object
+    constexpr Optional &operator=(T &value) noexcept
     {
-      return reinterpret_cast<const T *>(&data);
+      pointer = std::addressof(value);
+      return *this;
     }
+
+    /// @brief Deleted assignment from a temporary, the reference would dangle
+    Optional &operator=(std::remove_const_t<T> &&) = delete;
+
+    /// @brief Check if the Optional object has a reference
+    /// @return true if the Optional object has a reference, false otherwise
+    constexpr bool hasValue() const noexcept
+    {
+      return pointer != nullptr;
+    }
+
+    /// @brief Conversion operator to bool
+    /// @return true if the Optional object has a reference, false otherwise
+    constexpr explicit operator bool() const noexcept
+    {
+      return hasValue();
+    }
+
+    /// @brief Get the referenced value
+    /// @return The referenced value
+    constexpr T &getValue() const
+    {
+      if (!pointer)
+        throw std::runtime_error("Optional has no value");
+      return *pointer;
+    }
+
+    /// @brief Get the referenced value or a default value
+    ///
+    /// If the default value is an lvalue that T & can refer to, a reference is returned,
+    /// otherwise a copy of the referenced value or of the default value.
+    /// @tparam U The type of the default value
+    /// @param defaultValue The default value
+    /// @return The referenced value if it exists, otherwise the default value
+    template <typename U>
+    constexpr std::conditional_t<std::is_lvalue_reference<U>::value && std::is_convertible<std::remove_reference_t<U> *, T *>::value, T &, std::remove_cv_t<T>> getValueOr(U &&defaultValue) const
+    {
+      if constexpr (std::is_lvalue_reference<U>::value && std::is_convertible<std::remove_reference_t<U> *, T *>::value)
+      {
+        return pointer ? *pointer : defaultValue;
+      }
+      else
+      {
+        return pointer ? *pointer : static_cast<std::remove_cv_t<T>>(std::forward<U>(defaultValue));
+      }
+    }
+
+    /// @brief Get a copy of the referenced value or the result of a function, called only if there is no reference
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument
+    /// @return The referenced value if it exists, otherwise the result of f
+    template <typename F>
+    std::remove_cv_t<T> getValueOrElse(F &&f) const
+    {
+      return pointer ? *pointer : static_cast<std::remove_cv_t<T>>(std::invoke(std::forward<F>(f)));
+    }
+
+    /// @brief Apply a function to the referenced value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the referenced value
+    /// @return An Optional object storing the result of f, or no value if there is no reference
+    template <typename F>
+    auto transform(F &&f) const
+    {
+      using U = std::remove_cv_t<std::invoke_result_t<F, T &>>;
+      static_assert(!std::is_void<U>::value && !std::is_reference<U>::value, "transform: the function must return a value");
+      if (!pointer)
+      {
+        return Optional<U>();
+      }
+      return Optional<U>(details::OptionalInvokeStruct(), std::forward<F>(f), *pointer);
+    }
+
+    /// @brief Apply a function returning an Optional object to the referenced value
+    /// @tparam F The type of the function
+    /// @param f The function, called with the referenced value
+    /// @return The result of f, or no value if there is no reference
+    template <typename F>
+    auto andThen(F &&f) const
+    {
+      using R = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T &>>>;
+      static_assert(details::IsOptional<R>::value, "andThen: the function must return an Optional");
+      if (!pointer)
+      {
+        return R();
+      }
+      return R(std::invoke(std::forward<F>(f), *pointer));
+    }
+
+    /// @brief Get the Optional reference, or the result of a function if there is no reference
+    /// @tparam F The type of the function
+    /// @param f The function, called without argument, returning an Optional<T &>
+    /// @return The Optional reference if it has a reference, otherwise the result of f
+    template <typename F>
+    Optional orElse(F &&f) const
+    {
+      static_assert(std::is_same<std::decay_t<std::invoke_result_t<F>>, Optional>::value, "orElse: the function must return an Optional<T &>");
+      return pointer ? *this : std::invoke(std::forward<F>(f));
+    }
+
+    /// @brief Remove the reference, the referenced value is not modified
+    constexpr void clear() noexcept
+    {
+      pointer = nullptr;
+    }
+
+    /// @brief Rebind to another value
+    /// @param value The new referenced value
+    /// @return The new referenced value
+    constexpr T &emplace(T &value) noexcept
+    {
+      pointer = std::addressof(value);
+      return value;
+    }
+
+    /// @brief Dereference operator
+    /// @return The referenced value
+    constexpr T &operator*() const noexcept
+    {
+      return *pointer;
+    }
+
+    /// @brief Arrow operator
+    /// @return A pointer to the referenced value
+    constexpr T *operator->() const noexcept
+    {
+      return pointer;
+    }
+
+  private:
+    T *pointer = nullptr; ///< The referenced value, nullptr if there is none
   };
 
   /// @brief Create an Optional object from a value
@@ -217,7 +699,7 @@ namespace voc
   /// @param ...args The arguments to be passed to the constructor of T
   /// @return An Optional object storing the value
   template <typename T, typename... Args>
-  Optional<T> makeOptional(Args &&...args)
+  constexpr Optional<T> makeOptional(Args &&...args)
   {
     return Optional<T>(InPlace, std::forward<Args>(args)...);
   }
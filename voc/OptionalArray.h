@@ -0,0 +1,525 @@
+#ifndef VOC_OPTIONAL_ARRAY_H
+#define VOC_OPTIONAL_ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Optional.h"
+
+namespace voc
+{
+  namespace details
+  {
+    /// @brief Count the bits set in a word
+    /// @param word The word
+    /// @return The number of bits set
+    inline std::size_t popCount(std::uint64_t word) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+      std::size_t count = 0;
+      for (; word != 0; word &= word - 1)
+      {
+        ++count;
+      }
+      return count;
+#endif
+    }
+  }
+
+  /// @brief Column of optional values, the values in a dense buffer and their validity in a bitmap
+  ///
+  /// Compared to std::vector<Optional<T>>, there is one bit per element instead of a padded
+  /// bool, and the values are contiguous so that loops over them can be vectorized.
+  /// The elements without value hold a default-constructed T.
+  /// @tparam T The type of the values, must be default constructible
+  template <typename T>
+  class OptionalArray
+  {
+    static_assert(std::is_default_constructible<T>::value, "OptionalArray: T must be default constructible");
+    static_assert(!std::is_same<T, bool>::value, "OptionalArray: std::vector<bool> has no references to its elements, use std::uint8_t");
+
+  public:
+    /// @brief Number of bits in a word of the bitmap
+    static constexpr std::size_t WordBits = 64;
+
+    /// @brief Access to an element, with the API of Optional
+    /// @tparam Const Whether the element is read only
+    template <bool Const>
+    class Proxy
+    {
+    private:
+      using Array = std::conditional_t<Const, const OptionalArray, OptionalArray>;
+      using Value = std::conditional_t<Const, const T, T>;
+
+      Array *array;      ///< The array
+      std::size_t index; ///< The index of the element
+
+      friend class OptionalArray;
+
+      /// @brief Constructor
+      /// @param array The array
+      /// @param index The index of the element
+      Proxy(Array &array, std::size_t index) : array(&array), index(index) {}
+
+    public:
+      /// @brief Copy constructor, the copy refers to the same element
+      Proxy(const Proxy &) = default;
+
+      /// @brief Conversion from a mutable proxy to a read only proxy
+      /// @param other The mutable proxy
+      template <bool OtherConst, typename std::enable_if<Const && !OtherConst>::type * = nullptr>
+      Proxy(const Proxy<OtherConst> &other) : array(other.array), index(other.index) {}
+
+      /// @brief Assign the value of another element
+      /// @param other The other element
+      /// @return A reference to the current proxy
+      Proxy &operator=(const Proxy &other)
+      {
+        return *this = static_cast<Optional<T>>(other);
+      }
+
+      /// @brief Assign the value of another element
+      /// @param other The other element
+      /// @return A reference to the current proxy
+      template <bool OtherConst>
+      Proxy &operator=(const Proxy<OtherConst> &other)
+      {
+        return *this = static_cast<Optional<T>>(other);
+      }
+
+      /// @brief Assign a value
+      /// @param value The value
+      /// @return A reference to the current proxy
+      Proxy &operator=(const T &value)
+      {
+        array->values[index] = value;
+        array->setBit(index);
+        return *this;
+      }
+
+      /// @brief Assign a value
+      /// @param value The value
+      /// @return A reference to the current proxy
+      Proxy &operator=(T &&value)
+      {
+        array->values[index] = std::move(value);
+        array->setBit(index);
+        return *this;
+      }
+
+      /// @brief Assign an optional value
+      /// @param value The optional value
+      /// @return A reference to the current proxy
+      Proxy &operator=(const Optional<T> &value)
+      {
+        if (value.hasValue())
+        {
+          return *this = *value;
+        }
+        clear();
+        return *this;
+      }
+
+      /// @brief Conversion to Optional
+      /// @return An Optional object storing a copy of the value, if any
+      operator Optional<T>() const
+      {
+        return hasValue() ? Optional<T>(array->values[index]) : Optional<T>();
+      }
+
+      /// @brief Check if the element has a value
+      /// @return true if the element has a value, false otherwise
+      bool hasValue() const
+      {
+        return array->hasValue(index);
+      }
+
+      /// @brief Conversion operator to bool
+      /// @return true if the element has a value, false otherwise
+      explicit operator bool() const
+      {
+        return hasValue();
+      }
+
+      /// @brief Get the value
+      /// @return The value
+      Value &getValue() const
+      {
+        if (!hasValue())
+          throw std::runtime_error("OptionalArray element has no value");
+        return array->values[index];
+      }
+
+      /// @brief Get the value or a default value
+      /// @tparam U The type of the default value
+      /// @param defaultValue The default value
+      /// @return The value if it exists, otherwise the default value
+      template <typename U>
+      T getValueOr(U &&defaultValue) const
+      {
+        return hasValue() ? array->values[index] : static_cast<T>(std::forward<U>(defaultValue));
+      }
+
+      /// @brief Remove the value of the element
+      void clear()
+      {
+        array->values[index] = T();
+        array->clearBit(index);
+      }
+
+      /// @brief Replace the value by a value constructed in place
+      /// @tparam Args The types of the arguments to be passed to the constructor of T
+      /// @param ...args The arguments to be passed to the constructor of T
+      /// @return A reference to the new value
+      template <typename... Args>
+      T &emplace(Args &&...args)
+      {
+        array->values[index] = T(std::forward<Args>(args)...);
+        array->setBit(index);
+        return array->values[index];
+      }
+
+      /// @brief Dereference operator
+      /// @return A reference to the value
+      Value &operator*() const
+      {
+        return array->values[index];
+      }
+
+      /// @brief Arrow operator
+      /// @return A pointer to the value
+      Value *operator->() const
+      {
+        return std::addressof(array->values[index]);
+      }
+
+      template <bool>
+      friend class Proxy;
+    };
+
+    using Reference = Proxy<false>;     ///< Access to a mutable element
+    using ConstReference = Proxy<true>; ///< Access to a read only element
+
+    /// @brief Default constructor
+    OptionalArray() = default;
+
+    /// @brief Constructor with a number of elements without value
+    /// @param count The number of elements
+    explicit OptionalArray(std::size_t count) : values(count), validity(wordCount(count), 0) {}
+
+    /// @brief Get the number of elements
+    /// @return The number of elements
+    std::size_t size() const
+    {
+      return values.size();
+    }
+
+    /// @brief Check if the array has no element
+    /// @return true if there is no element, false otherwise
+    bool empty() const
+    {
+      return values.empty();
+    }
+
+    /// @brief Reserve memory for a number of elements
+    /// @param count The number of elements
+    void reserve(std::size_t count)
+    {
+      values.reserve(count);
+      validity.reserve(wordCount(count));
+    }
+
+    /// @brief Remove all the elements
+    void clear()
+    {
+      values.clear();
+      validity.clear();
+    }
+
+    /// @brief Access an element
+    /// @param index The index of the element
+    /// @return A proxy to the element
+    Reference operator[](std::size_t index)
+    {
+      return Reference(*this, index);
+    }
+
+    /// @brief Access an element
+    /// @param index The index of the element
+    /// @return A read only proxy to the element
+    ConstReference operator[](std::size_t index) const
+    {
+      return ConstReference(*this, index);
+    }
+
+    /// @brief Check if an element has a value
+    /// @param index The index of the element
+    /// @return true if the element has a value, false otherwise
+    bool hasValue(std::size_t index) const
+    {
+      return (validity[index / WordBits] >> (index % WordBits)) & 1;
+    }
+
+    /// @brief Get the values, the elements without value hold a default-constructed T
+    /// @return A pointer to the contiguous values
+    const T *data() const
+    {
+      return values.data();
+    }
+
+    /// @brief Get the validity bitmap, bit i of word i / 64 is set if element i has a value
+    /// @return A pointer to the words of the bitmap, the bits after the last element are zero
+    const std::uint64_t *bitmap() const
+    {
+      return validity.data();
+    }
+
+    /// @brief Add a value at the end
+    /// @param value The value
+    void pushBack(const T &value)
+    {
+      values.push_back(value);
+      appendBit(true);
+    }
+
+    /// @brief Add a value at the end
+    /// @param value The value
+    void pushBack(T &&value)
+    {
+      values.push_back(std::move(value));
+      appendBit(true);
+    }
+
+    /// @brief Add an optional value at the end
+    /// @param value The optional value
+    void pushBack(const Optional<T> &value)
+    {
+      if (value.hasValue())
+      {
+        pushBack(*value);
+      }
+      else
+      {
+        pushNull();
+      }
+    }
+
+    /// @brief Add an element without value at the end
+    void pushNull()
+    {
+      values.emplace_back();
+      appendBit(false);
+    }
+
+    /// @brief Count the elements that have a value
+    /// @return The number of elements with a value
+    std::size_t countValues() const
+    {
+      std::size_t count = 0;
+      for (std::uint64_t word : validity)
+      {
+        count += details::popCount(word);
+      }
+      return count;
+    }
+
+    /// @brief Copy the values, with a default value for the elements without value
+    ///
+    /// This is getValueOr on the whole array. The values are selected without branch,
+    /// so that the loop can be vectorized.
+    /// @param defaultValue The value of the elements without value
+    /// @param out The destination, with room for size() values, may be data()
+    void getValuesOr(const T &defaultValue, T *out) const
+    {
+      const T *in = values.data();
+      for (std::size_t word = 0; word < validity.size(); ++word)
+      {
+        std::uint64_t bits = validity[word];
+        std::size_t begin = word * WordBits;
+        std::size_t count = std::min(WordBits, values.size() - begin);
+        if (bits == lowMask(count))
+        {
+          if (out != in)
+          {
+            std::copy(in + begin, in + begin + count, out + begin);
+          }
+        }
+        else if (bits == 0)
+        {
+          std::fill(out + begin, out + begin + count, defaultValue);
+        }
+        else
+        {
+          const T *first = in + begin;
+          T *result = out + begin;
+          if constexpr (std::is_trivially_copyable<T>::value)
+          {
+            const T fill = defaultValue; // copies, so that both sides of the select are plain loads
+            for (std::size_t i = 0; i < count; ++i)
+            {
+              T value = first[i];
+              result[i] = ((bits >> i) & 1) ? value : fill;
+            }
+          }
+          else
+          {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+              result[i] = ((bits >> i) & 1) ? first[i] : defaultValue;
+            }
+          }
+        }
+      }
+    }
+
+    /// @brief Give a value to all the elements without value, they all have a value afterwards
+    /// @param defaultValue The value of the elements without value
+    void fillNulls(const T &defaultValue)
+    {
+      getValuesOr(defaultValue, values.data());
+      for (std::size_t word = 0; word < validity.size(); ++word)
+      {
+        validity[word] = lowMask(std::min(WordBits, values.size() - word * WordBits));
+      }
+    }
+
+    /// @brief Add the elements of another array at the end
+    ///
+    /// If copying a value throws, the array is left unchanged.
+    /// @param other The other array, may be this array
+    void append(const OptionalArray &other)
+    {
+      if (&other == this)
+      {
+        append(OptionalArray(other)); // the elements would be read while the array grows
+        return;
+      }
+      std::size_t offset = size();
+      std::size_t words = validity.size();
+      validity.resize(wordCount(offset + other.size()), 0);
+      try
+      {
+        values.insert(values.end(), other.values.begin(), other.values.end());
+      }
+      catch (...)
+      {
+        validity.resize(words);
+        throw;
+      }
+      copyBits(other.validity, 0, offset, other.size());
+    }
+
+    /// @brief Copy a range of elements
+    /// @param offset The index of the first element
+    /// @param count The number of elements
+    /// @return A new array with the elements
+    /// @throw std::out_of_range if the range is not in the array
+    OptionalArray slice(std::size_t offset, std::size_t count) const
+    {
+      if (offset > size() || count > size() - offset)
+      {
+        throw std::out_of_range("OptionalArray::slice: the range is out of the array");
+      }
+      OptionalArray result;
+      result.values.assign(values.begin() + offset, values.begin() + offset + count);
+      result.validity.resize(wordCount(count), 0);
+      result.copyBits(validity, offset, 0, count);
+      return result;
+    }
+
+  private:
+    std::vector<T> values;               ///< The values, default-constructed for the elements without value
+    std::vector<std::uint64_t> validity; ///< The validity bitmap
+
+    /// @brief Get the number of words of the bitmap for a number of elements
+    /// @param count The number of elements
+    /// @return The number of words
+    static std::size_t wordCount(std::size_t count)
+    {
+      return (count + WordBits - 1) / WordBits;
+    }
+
+    /// @brief Get a word with the lowest bits set
+    /// @param count The number of bits set, at most 64
+    /// @return The word
+    static std::uint64_t lowMask(std::size_t count)
+    {
+      return count >= WordBits ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+    }
+
+    /// @brief Add the bit of the last element, the value is already added
+    /// @param bit Whether the element has a value
+    void appendBit(bool bit)
+    {
+      std::size_t index = values.size() - 1;
+      if (index % WordBits == 0)
+      {
+        try
+        {
+          validity.push_back(0);
+        }
+        catch (...)
+        {
+          values.pop_back();
+          throw;
+        }
+      }
+      validity.back() |= std::uint64_t(bit) << (index % WordBits);
+    }
+
+    /// @brief Set the bit of an element
+    /// @param index The index of the element
+    void setBit(std::size_t index)
+    {
+      validity[index / WordBits] |= std::uint64_t(1) << (index % WordBits);
+    }
+
+    /// @brief Clear the bit of an element
+    /// @param index The index of the element
+    void clearBit(std::size_t index)
+    {
+      validity[index / WordBits] &= ~(std::uint64_t(1) << (index % WordBits));
+    }
+
+    /// @brief Copy bits of another bitmap, a word at a time
+    /// @param source The other bitmap
+    /// @param from The index of the first bit to copy
+    /// @param to The index of the first bit to write, the bits written must be zero
+    /// @param count The number of bits
+    void copyBits(const std::vector<std::uint64_t> &source, std::size_t from, std::size_t to, std::size_t count)
+    {
+      for (std::size_t done = 0; done < count; done += WordBits)
+      {
+        std::size_t length = std::min(WordBits, count - done);
+
+        std::size_t word = (from + done) / WordBits;
+        std::size_t shift = (from + done) % WordBits;
+        std::uint64_t bits = source[word] >> shift;
+        if (shift != 0 && shift + length > WordBits)
+        {
+          bits |= source[word + 1] << (WordBits - shift);
+        }
+        bits &= lowMask(length);
+
+        word = (to + done) / WordBits;
+        shift = (to + done) % WordBits;
+        validity[word] |= bits << shift;
+        if (shift != 0 && shift + length > WordBits)
+        {
+          validity[word + 1] |= bits >> (WordBits - shift);
+        }
+      }
+    }
+  };
+
+} // namespace voc
+
+#endif // VOC_OPTIONAL_ARRAY_H
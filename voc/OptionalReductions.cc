@@ -0,0 +1,321 @@
+#include "OptionalReductions.h"
+
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VOC_HAS_X86_SIMD 1 // the SIMD kernels are compiled with target attributes, selected at runtime
+#include <immintrin.h>
+#else
+#define VOC_HAS_X86_SIMD 0 // only the scalar kernels are available
+#endif
+
+namespace voc
+{
+  SimdLevel detectSimdLevel()
+  {
+    static const SimdLevel level = []() {
+#if VOC_HAS_X86_SIMD
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+      {
+        return SimdLevel::Avx2;
+      }
+      if (__builtin_cpu_supports("sse2"))
+      {
+        return SimdLevel::Sse2;
+      }
+#endif
+      return SimdLevel::Scalar;
+    }();
+    return level;
+  }
+
+  namespace
+  {
+#if VOC_HAS_X86_SIMD
+    /// @brief Get the level to use, never above the one supported by the processor
+    /// @param level The requested level
+    /// @return The level to use
+    SimdLevel clampLevel(SimdLevel level)
+    {
+      return std::min(level, detectSimdLevel());
+    }
+
+    /// @brief Number of values in the words processed with vectors, the rest is processed by the scalar kernels
+    /// @param count The number of values
+    /// @return The number of values in complete words
+    std::size_t vectorCount(std::size_t count)
+    {
+      return count - count % 64;
+    }
+
+    /// @brief Masks of two lanes of 64 bits, indexed by two validity bits
+    alignas(16) const std::uint64_t Sse2Masks[4][2] = {{0, 0}, {~std::uint64_t(0), 0}, {0, ~std::uint64_t(0)}, {~std::uint64_t(0), ~std::uint64_t(0)}};
+
+    /// @brief Expand two validity bits to a mask of two doubles
+    /// @param bits The validity bits, in the lowest bits
+    /// @return The mask, all ones for the present values
+    __attribute__((target("sse2"))) inline __m128d sse2Mask(std::uint64_t bits)
+    {
+      return _mm_load_pd(reinterpret_cast<const double *>(Sse2Masks[bits & 3]));
+    }
+
+    /// @brief Expand four validity bits to a mask of four doubles
+    /// @param bits The validity bits, in the lowest bits
+    /// @return The mask, all ones for the present values
+    __attribute__((target("avx2"))) inline __m256d avx2Mask(std::uint64_t bits)
+    {
+      const __m256i lanes = _mm256_setr_epi64x(1, 2, 4, 8);
+      __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(bits)), lanes);
+      return _mm256_castsi256_pd(_mm256_cmpeq_epi64(selected, lanes));
+    }
+
+    /// @brief Sum the present values of the complete words with SSE2
+    __attribute__((target("sse2"))) double sumSse2(const double *values, const std::uint64_t *validity, std::size_t count)
+    {
+      __m128d first = _mm_setzero_pd();
+      __m128d second = _mm_setzero_pd();
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        if (bits == 0)
+        {
+          continue;
+        }
+        const double *block = values + begin;
+        for (std::size_t i = 0; i < 64; i += 4, bits >>= 4)
+        {
+          first = _mm_add_pd(first, _mm_and_pd(_mm_loadu_pd(block + i), sse2Mask(bits)));
+          second = _mm_add_pd(second, _mm_and_pd(_mm_loadu_pd(block + i + 2), sse2Mask(bits >> 2)));
+        }
+      }
+      alignas(16) double lanes[2];
+      _mm_store_pd(lanes, _mm_add_pd(first, second));
+      return lanes[0] + lanes[1];
+    }
+
+    /// @brief Sum the present values of the complete words with AVX2
+    __attribute__((target("avx2"))) double sumAvx2(const double *values, const std::uint64_t *validity, std::size_t count)
+    {
+      __m256d first = _mm256_setzero_pd();
+      __m256d second = _mm256_setzero_pd();
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        if (bits == 0)
+        {
+          continue;
+        }
+        const double *block = values + begin;
+        for (std::size_t i = 0; i < 64; i += 8, bits >>= 8)
+        {
+          first = _mm256_add_pd(first, _mm256_and_pd(_mm256_loadu_pd(block + i), avx2Mask(bits)));
+          second = _mm256_add_pd(second, _mm256_and_pd(_mm256_loadu_pd(block + i + 4), avx2Mask(bits >> 4)));
+        }
+      }
+      alignas(32) double lanes[4];
+      _mm256_store_pd(lanes, _mm256_add_pd(first, second));
+      return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    /// @brief Compute the minimum or the maximum of the present values of the complete words with SSE2
+    /// @tparam Max Whether the maximum is computed
+    /// @param present Set to true if a value is present
+    /// @return The minimum or maximum, infinity if no value is present
+    template <bool Max>
+    __attribute__((target("sse2"))) double extremumSse2(const double *values, const std::uint64_t *validity, std::size_t count, bool &present)
+    {
+      const double neutral = Max ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+      const __m128d fill = _mm_set1_pd(neutral);
+      __m128d first = fill;
+      __m128d second = fill;
+      std::uint64_t seen = 0;
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        seen |= bits;
+        if (bits == 0)
+        {
+          continue;
+        }
+        const double *block = values + begin;
+        for (std::size_t i = 0; i < 64; i += 4, bits >>= 4)
+        {
+          __m128d mask = sse2Mask(bits);
+          __m128d a = _mm_or_pd(_mm_and_pd(mask, _mm_loadu_pd(block + i)), _mm_andnot_pd(mask, fill));
+          mask = sse2Mask(bits >> 2);
+          __m128d b = _mm_or_pd(_mm_and_pd(mask, _mm_loadu_pd(block + i + 2)), _mm_andnot_pd(mask, fill));
+          first = Max ? _mm_max_pd(first, a) : _mm_min_pd(first, a);
+          second = Max ? _mm_max_pd(second, b) : _mm_min_pd(second, b);
+        }
+      }
+      alignas(16) double lanes[2];
+      _mm_store_pd(lanes, Max ? _mm_max_pd(first, second) : _mm_min_pd(first, second));
+      present = seen != 0;
+      return Max ? std::max(lanes[0], lanes[1]) : std::min(lanes[0], lanes[1]);
+    }
+
+    /// @brief Compute the minimum or the maximum of the present values of the complete words with AVX2
+    /// @tparam Max Whether the maximum is computed
+    /// @param present Set to true if a value is present
+    /// @return The minimum or maximum, infinity if no value is present
+    template <bool Max>
+    __attribute__((target("avx2"))) double extremumAvx2(const double *values, const std::uint64_t *validity, std::size_t count, bool &present)
+    {
+      const double neutral = Max ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+      const __m256d fill = _mm256_set1_pd(neutral);
+      __m256d first = fill;
+      __m256d second = fill;
+      std::uint64_t seen = 0;
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        seen |= bits;
+        if (bits == 0)
+        {
+          continue;
+        }
+        const double *block = values + begin;
+        for (std::size_t i = 0; i < 64; i += 8, bits >>= 8)
+        {
+          __m256d a = _mm256_blendv_pd(fill, _mm256_loadu_pd(block + i), avx2Mask(bits));
+          __m256d b = _mm256_blendv_pd(fill, _mm256_loadu_pd(block + i + 4), avx2Mask(bits >> 4));
+          first = Max ? _mm256_max_pd(first, a) : _mm256_min_pd(first, a);
+          second = Max ? _mm256_max_pd(second, b) : _mm256_min_pd(second, b);
+        }
+      }
+      alignas(32) double lanes[4];
+      _mm256_store_pd(lanes, Max ? _mm256_max_pd(first, second) : _mm256_min_pd(first, second));
+      present = seen != 0;
+      return Max ? std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]))
+                 : std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    }
+
+    /// @brief Coalesce the values of the complete words with SSE2
+    __attribute__((target("sse2"))) void coalesceSse2(const double *values, const std::uint64_t *validity, std::size_t count, double defaultValue, double *out)
+    {
+      const __m128d fill = _mm_set1_pd(defaultValue);
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        for (std::size_t i = begin; i < begin + 64; i += 2, bits >>= 2)
+        {
+          __m128d mask = sse2Mask(bits);
+          _mm_storeu_pd(out + i, _mm_or_pd(_mm_and_pd(mask, _mm_loadu_pd(values + i)), _mm_andnot_pd(mask, fill)));
+        }
+      }
+    }
+
+    /// @brief Coalesce the values of the complete words with AVX2
+    __attribute__((target("avx2"))) void coalesceAvx2(const double *values, const std::uint64_t *validity, std::size_t count, double defaultValue, double *out)
+    {
+      const __m256d fill = _mm256_set1_pd(defaultValue);
+      for (std::size_t begin = 0; begin < vectorCount(count); begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        for (std::size_t i = begin; i < begin + 64; i += 4, bits >>= 4)
+        {
+          _mm256_storeu_pd(out + i, _mm256_blendv_pd(fill, _mm256_loadu_pd(values + i), avx2Mask(bits)));
+        }
+      }
+    }
+#endif
+
+    /// @brief Compute the minimum or the maximum of the present values
+    /// @tparam Max Whether the maximum is computed
+    /// @return The minimum or maximum, no value if there is none
+    template <bool Max>
+    Optional<double> extremum(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level)
+    {
+      std::size_t done = 0;
+      bool present = false;
+      double result = 0;
+#if VOC_HAS_X86_SIMD
+      switch (clampLevel(level))
+      {
+      case SimdLevel::Avx2:
+        result = extremumAvx2<Max>(values, validity, count, present);
+        done = vectorCount(count);
+        break;
+      case SimdLevel::Sse2:
+        result = extremumSse2<Max>(values, validity, count, present);
+        done = vectorCount(count);
+        break;
+      case SimdLevel::Scalar:
+        break;
+      }
+#else
+      (void)level;
+#endif
+      Optional<double> tail = Max ? maskedMax<double>(values + done, validity + done / 64, count - done)
+                                  : maskedMin<double>(values + done, validity + done / 64, count - done);
+      if (!present)
+      {
+        return tail;
+      }
+      if (!tail.hasValue())
+      {
+        return result;
+      }
+      return Max ? std::max(result, *tail) : std::min(result, *tail);
+    }
+  }
+
+  double maskedSum(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level)
+  {
+    std::size_t done = 0;
+    double result = 0;
+#if VOC_HAS_X86_SIMD
+    switch (clampLevel(level))
+    {
+    case SimdLevel::Avx2:
+      result = sumAvx2(values, validity, count);
+      done = vectorCount(count);
+      break;
+    case SimdLevel::Sse2:
+      result = sumSse2(values, validity, count);
+      done = vectorCount(count);
+      break;
+    case SimdLevel::Scalar:
+      break;
+    }
+#else
+    (void)level;
+#endif
+    return result + maskedSum<double>(values + done, validity + done / 64, count - done);
+  }
+
+  Optional<double> maskedMin(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level)
+  {
+    return extremum<false>(values, validity, count, level);
+  }
+
+  Optional<double> maskedMax(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level)
+  {
+    return extremum<true>(values, validity, count, level);
+  }
+
+  void maskedCoalesce(const double *values, const std::uint64_t *validity, std::size_t count, double defaultValue, double *out, SimdLevel level)
+  {
+    std::size_t done = 0;
+#if VOC_HAS_X86_SIMD
+    switch (clampLevel(level))
+    {
+    case SimdLevel::Avx2:
+      coalesceAvx2(values, validity, count, defaultValue, out);
+      done = vectorCount(count);
+      break;
+    case SimdLevel::Sse2:
+      coalesceSse2(values, validity, count, defaultValue, out);
+      done = vectorCount(count);
+      break;
+    case SimdLevel::Scalar:
+      break;
+    }
+#else
+    (void)level;
+#endif
+    maskedCoalesce<double>(values + done, validity + done / 64, count - done, defaultValue, out + done);
+  }
+
+} // namespace voc
@@ -0,0 +1,257 @@
+#ifndef VOC_OPTIONAL_REDUCTIONS_H
+#define VOC_OPTIONAL_REDUCTIONS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "Optional.h"
+#include "OptionalArray.h"
+
+namespace voc
+{
+  /// @brief Instruction set used by the reductions of optional values
+  enum class SimdLevel
+  {
+    Scalar, ///< Plain C++
+    Sse2,   ///< 128-bit vectors
+    Avx2    ///< 256-bit vectors
+  };
+
+  /// @brief Get the best instruction set supported by the processor, detected once
+  /// @return The best supported level, Scalar on other architectures than x86
+  SimdLevel detectSimdLevel();
+
+  // The reductions take the values and a validity bitmap in the layout of OptionalArray:
+  // bit i % 64 of word i / 64 is set if value i is present. The values that are not present
+  // are never used, they may hold anything. The overloads for double use SIMD instructions,
+  // with the best level supported by the processor unless a lower one is requested.
+
+  /// @brief Count the present values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @return The number of present values
+  inline std::size_t maskedCount(const std::uint64_t *validity, std::size_t count)
+  {
+    std::size_t words = count / 64;
+    std::size_t result = 0;
+    for (std::size_t word = 0; word < words; ++word)
+    {
+      result += details::popCount(validity[word]);
+    }
+    if (count % 64 != 0)
+    {
+      result += details::popCount(validity[words] & ((std::uint64_t(1) << (count % 64)) - 1));
+    }
+    return result;
+  }
+
+  /// @brief Sum the present values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @param level The highest instruction set to use
+  /// @return The sum of the present values, 0 if there is none
+  double maskedSum(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level = detectSimdLevel());
+
+  /// @brief Get the smallest present value
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @param level The highest instruction set to use
+  /// @return The smallest present value, no value if there is none, unspecified if a value is NaN
+  Optional<double> maskedMin(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level = detectSimdLevel());
+
+  /// @brief Get the largest present value
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @param level The highest instruction set to use
+  /// @return The largest present value, no value if there is none, unspecified if a value is NaN
+  Optional<double> maskedMax(const double *values, const std::uint64_t *validity, std::size_t count, SimdLevel level = detectSimdLevel());
+
+  /// @brief Copy the values, with a default value for the values that are not present
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @param defaultValue The value written for the values that are not present
+  /// @param out The destination, with room for count values, may be values
+  /// @param level The highest instruction set to use
+  void maskedCoalesce(const double *values, const std::uint64_t *validity, std::size_t count, double defaultValue, double *out, SimdLevel level = detectSimdLevel());
+
+  namespace details
+  {
+    /// @brief Call a function on the present values, the words without value are skipped
+    /// @tparam T The type of the values
+    /// @tparam F The type of the function
+    /// @param values The values
+    /// @param validity The validity bitmap
+    /// @param count The number of values
+    /// @param f The function, called with each present value
+    template <typename T, typename F>
+    void forEachPresent(const T *values, const std::uint64_t *validity, std::size_t count, F &&f)
+    {
+      for (std::size_t begin = 0; begin < count; begin += 64)
+      {
+        std::uint64_t bits = validity[begin / 64];
+        std::size_t end = std::min(begin + 64, count);
+        for (std::size_t i = begin; bits != 0 && i < end; ++i, bits >>= 1)
+        {
+          if (bits & 1)
+          {
+            f(values[i]);
+          }
+        }
+      }
+    }
+  }
+
+  /// @brief Sum the present values, without SIMD instructions
+  /// @tparam T The type of the values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @return The sum of the present values, T() if there is none
+  template <typename T>
+  T maskedSum(const T *values, const std::uint64_t *validity, std::size_t count)
+  {
+    T result = T();
+    details::forEachPresent(values, validity, count, [&](const T &value) { result += value; });
+    return result;
+  }
+
+  /// @brief Get the smallest present value, without SIMD instructions
+  /// @tparam T The type of the values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @return The smallest present value, no value if there is none
+  template <typename T>
+  Optional<T> maskedMin(const T *values, const std::uint64_t *validity, std::size_t count)
+  {
+    Optional<T> result;
+    details::forEachPresent(values, validity, count, [&](const T &value) {
+      if (!result.hasValue() || value < *result)
+      {
+        result = value;
+      }
+    });
+    return result;
+  }
+
+  /// @brief Get the largest present value, without SIMD instructions
+  /// @tparam T The type of the values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @return The largest present value, no value if there is none
+  template <typename T>
+  Optional<T> maskedMax(const T *values, const std::uint64_t *validity, std::size_t count)
+  {
+    Optional<T> result;
+    details::forEachPresent(values, validity, count, [&](const T &value) {
+      if (!result.hasValue() || *result < value)
+      {
+        result = value;
+      }
+    });
+    return result;
+  }
+
+  /// @brief Copy the values, with a default value for the values that are not present, without SIMD instructions
+  /// @tparam T The type of the values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @param defaultValue The value written for the values that are not present
+  /// @param out The destination, with room for count values, may be values
+  template <typename T>
+  void maskedCoalesce(const T *values, const std::uint64_t *validity, std::size_t count, const T &defaultValue, T *out)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      out[i] = ((validity[i / 64] >> (i % 64)) & 1) ? values[i] : defaultValue;
+    }
+  }
+
+  /// @brief Get the mean of the present values
+  /// @tparam T The type of the values
+  /// @param values The values
+  /// @param validity The validity bitmap
+  /// @param count The number of values
+  /// @return The mean of the present values, no value if there is none
+  template <typename T>
+  Optional<double> maskedMean(const T *values, const std::uint64_t *validity, std::size_t count)
+  {
+    std::size_t present = maskedCount(validity, count);
+    if (present == 0)
+    {
+      return Optional<double>();
+    }
+    return static_cast<double>(maskedSum(values, validity, count)) / static_cast<double>(present);
+  }
+
+  /// @brief Count the values of an OptionalArray
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @return The number of elements with a value
+  template <typename T>
+  std::size_t maskedCount(const OptionalArray<T> &array)
+  {
+    return maskedCount(array.bitmap(), array.size());
+  }
+
+  /// @brief Sum the values of an OptionalArray
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @return The sum of the values, T() if there is none
+  template <typename T>
+  T maskedSum(const OptionalArray<T> &array)
+  {
+    return maskedSum(array.data(), array.bitmap(), array.size());
+  }
+
+  /// @brief Get the smallest value of an OptionalArray
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @return The smallest value, no value if there is none
+  template <typename T>
+  Optional<T> maskedMin(const OptionalArray<T> &array)
+  {
+    return maskedMin(array.data(), array.bitmap(), array.size());
+  }
+
+  /// @brief Get the largest value of an OptionalArray
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @return The largest value, no value if there is none
+  template <typename T>
+  Optional<T> maskedMax(const OptionalArray<T> &array)
+  {
+    return maskedMax(array.data(), array.bitmap(), array.size());
+  }
+
+  /// @brief Get the mean of the values of an OptionalArray
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @return The mean of the values, no value if there is none
+  template <typename T>
+  Optional<double> maskedMean(const OptionalArray<T> &array)
+  {
+    return maskedMean(array.data(), array.bitmap(), array.size());
+  }
+
+  /// @brief Copy the values of an OptionalArray, with a default value for the elements without value
+  /// @tparam T The type of the values
+  /// @param array The array
+  /// @param defaultValue The value written for the elements without value
+  /// @param out The destination, with room for array.size() values
+  template <typename T>
+  void maskedCoalesce(const OptionalArray<T> &array, const T &defaultValue, T *out)
+  {
+    maskedCoalesce(array.data(), array.bitmap(), array.size(), defaultValue, out);
+  }
+
+} // namespace voc
+
+#endif // VOC_OPTIONAL_REDUCTIONS_H
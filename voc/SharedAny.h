@@ -0,0 +1,354 @@
+#ifndef VOC_SHARED_ANY_H
+#define VOC_SHARED_ANY_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Any.h"
+
+namespace voc
+{
+  class SharedAny;
+  class AtomicAny;
+
+  namespace details
+  {
+    template <>
+    struct IsAnyWrapper<SharedAny> : std::true_type
+    {
+    };
+
+    /// @brief Shared payload of SharedAny, a reference count and the value
+    struct SharedAnyNode
+    {
+      std::atomic<std::size_t> count; ///< The number of SharedAny objects sharing the payload
+      Any value;                      ///< The shared value
+    };
+  }
+
+  /// @brief Class to share a value of any type between copies
+  ///
+  /// Copies share the same payload and only increment an atomic reference count.
+  /// The value is cloned when mutable access is requested while it is shared, so
+  /// a SharedAny object behaves as if it owned its own value. As with std::shared_ptr,
+  /// different SharedAny objects can be used concurrently, even if they share a payload.
+  class SharedAny
+  {
+  private:
+    details::SharedAnyNode *node = nullptr; ///< The shared payload, nullptr if empty
+
+  public:
+    /// @brief Default constructor
+    SharedAny() noexcept = default;
+
+    /// @brief Constructor from a value
+    /// @tparam T The type of the value to be stored
+    /// @param value The value to be stored
+    template <typename T, typename std::enable_if<!std::is_same<SharedAny, std::decay_t<T>>::value && !details::IsInPlaceType<std::decay_t<T>>::value && !details::IsBasicAny<std::decay_t<T>>::value>::type * = nullptr>
+    SharedAny(T &&value) : SharedAny(InPlaceType<std::decay_t<T>>, std::forward<T>(value)) {}
+
+    /// @brief Constructor from a value and a type struct
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param type The type struct
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename T, typename... Args>
+    SharedAny(InPlaceTypeStruct<T> type, Args &&...args) : node(new details::SharedAnyNode{{1}, Any(type, std::forward<Args>(args)...)}) {}
+
+    /// @brief Constructor from an Any object, the value is copied
+    /// @param any The Any object to be copied
+    explicit SharedAny(const Any &any) : SharedAny(Any(any)) {}
+
+    /// @brief Constructor from an Any object, the value is moved without being copied
+    /// @param any The Any object to be moved
+    explicit SharedAny(Any &&any)
+    {
+      if (any)
+      {
+        node = new details::SharedAnyNode{{1}, std::move(any)};
+      }
+    }
+
+    /// @brief Copy constructor, the payload is shared
+    /// @param other The other SharedAny object to be copied
+    SharedAny(const SharedAny &other) noexcept : node(other.node)
+    {
+      if (node)
+      {
+        node->count.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    /// @brief Move constructor
+    /// @param other The other SharedAny object to be moved
+    SharedAny(SharedAny &&other) noexcept : node(std::exchange(other.node, nullptr)) {}
+
+    /// @brief Destructor
+    ~SharedAny()
+    {
+      clear();
+    }
+
+    /// @brief Copy assignment operator, the payload is shared
+    /// @param other The other SharedAny object to be copied
+    /// @return A reference to the current object
+    SharedAny &operator=(const SharedAny &other) noexcept
+    {
+      SharedAny(other).swap(*this);
+      return *this;
+    }
+
+    /// @brief Move assignment operator
+    /// @param other The other SharedAny object to be moved
+    /// @return A reference to the current object
+    SharedAny &operator=(SharedAny &&other) noexcept
+    {
+      SharedAny(std::move(other)).swap(*this);
+      return *this;
+    }
+
+    /// @brief Conversion to an Any object, the value is copied
+    /// @return An Any object storing a copy of the value
+    explicit operator Any() const &
+    {
+      return node ? node->value : Any();
+    }
+
+    /// @brief Conversion to an Any object, the value is moved if it is not shared
+    /// @return An Any object storing the value
+    explicit operator Any() &&
+    {
+      if (!isUnique())
+      {
+        return static_cast<const SharedAny &>(*this).operator Any();
+      }
+      Any any = std::move(node->value);
+      clear();
+      return any;
+    }
+
+    /// @brief Swap with another SharedAny object
+    /// @param other The other SharedAny object
+    void swap(SharedAny &other) noexcept
+    {
+      std::swap(node, other.node);
+    }
+
+    /// @brief Check if the SharedAny object has a value
+    /// @return true if the SharedAny object has a value, false otherwise
+    bool hasValue() const
+    {
+      return node != nullptr;
+    }
+
+    /// @brief Conversion operator to bool
+    /// @return true if the SharedAny object has a value, false otherwise
+    explicit operator bool() const noexcept
+    {
+      return hasValue();
+    }
+
+    /// @brief Get the number of SharedAny objects sharing the value
+    /// @return The number of SharedAny objects sharing the value, 0 if empty
+    std::size_t useCount() const
+    {
+      return node ? node->count.load(std::memory_order_acquire) : 0;
+    }
+
+    /// @brief Check if the value is not shared with another SharedAny object
+    /// @return true if the value is not shared or if the SharedAny object is empty, false otherwise
+    bool isUnique() const
+    {
+      return useCount() <= 1;
+    }
+
+    /// @brief Clone the value if it is shared, so that it can be modified
+    void makeUnique()
+    {
+      if (!isUnique())
+      {
+        SharedAny(node->value).swap(*this);
+      }
+    }
+
+    /// @brief Clear the SharedAny object, the value is destroyed if it is not shared
+    void clear()
+    {
+      if (node && node->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        delete node;
+      }
+      node = nullptr;
+    }
+
+    /// @brief Replace the stored value by a value constructed in place
+    /// @tparam T The type of the value to be stored
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the new stored value
+    template <typename T, typename... Args>
+    std::decay_t<T> &emplace(Args &&...args)
+    {
+      SharedAny(InPlaceType<std::decay_t<T>>, std::forward<Args>(args)...).swap(*this);
+      return details::AnyAccess::get<std::decay_t<T>>(node->value);
+    }
+
+#if VOC_HAS_RTTI
+    /// @brief Get the type of the stored value
+    /// @return The type_info of the stored value, typeid(void) if the SharedAny object is empty
+    const std::type_info &getType() const
+    {
+      return node ? node->value.getType() : typeid(void);
+    }
+#else
+    /// @brief Get the type of the stored value, without RTTI it is the same as getTypeId()
+    /// @return The identifier of the stored type, typeId<void>() if the SharedAny object is empty
+    TypeId getType() const
+    {
+      return getTypeId();
+    }
+#endif
+
+    /// @brief Get the identifier of the stored type
+    /// @return The identifier of the stored type, typeId<void>() if the SharedAny object is empty
+    TypeId getTypeId() const
+    {
+      return node ? node->value.getTypeId() : typeId<void>();
+    }
+
+    /// @brief Check if the SharedAny object stores a value of type T
+    /// @tparam T The type to check
+    /// @return true if the stored value is of type T, false otherwise or if the SharedAny object is empty
+    template <typename T>
+    bool holds() const
+    {
+      return node && node->value.holds<T>();
+    }
+
+    /// @brief Get a pointer to the stored value
+    /// @return A pointer to the stored value, nullptr if the SharedAny object is empty
+    const void *contentPtr() const
+    {
+      return node ? node->value.contentPtr() : nullptr;
+    }
+
+    friend class AtomicAny;
+
+    template <typename T>
+    friend T *anyCast(SharedAny *any);
+
+    template <typename T>
+    friend const T *anyCast(const SharedAny *any) noexcept;
+  };
+
+  /// @brief Create a SharedAny object from a value
+  /// @tparam T The type of the value to be stored
+  /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+  /// @param ...args The arguments to be passed to the constructor of T
+  /// @return A SharedAny object storing the value
+  template <typename T, typename... Args>
+  SharedAny makeSharedAny(Args &&...args)
+  {
+    return SharedAny(InPlaceType<T>, std::forward<Args>(args)...);
+  }
+
+  /// @brief Cast a SharedAny object to a T pointer, the value is cloned if it is shared
+  /// @tparam T The type of the value to be casted
+  /// @param any The SharedAny object to be casted
+  /// @return A pointer to the stored value, or nullptr if the cast fails
+  template <typename T>
+  T *anyCast(SharedAny *any)
+  {
+    if (any && any->holds<T>())
+    {
+      any->makeUnique();
+      return anyCast<T>(&any->node->value);
+    }
+    return nullptr;
+  }
+
+  /// @brief Cast a SharedAny object to a const T pointer, the value is never cloned
+  /// @tparam T The type of the value to be casted
+  /// @param any The SharedAny object to be casted
+  /// @return A const pointer to the stored value, or nullptr if the cast fails
+  template <typename T>
+  const T *anyCast(const SharedAny *any) noexcept
+  {
+    if (any && any->node)
+    {
+      return anyCast<T>(&static_cast<const Any &>(any->node->value));
+    }
+    return nullptr;
+  }
+
+  /// @brief Cast a SharedAny object to a T object
+  /// @tparam T The type of the value to be casted, may be a const reference to access the value without copy
+  /// @param any The SharedAny object to be casted
+  /// @return An object of type T
+  template <typename T>
+  T anyCast(const SharedAny &any)
+  {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    static_assert(std::is_constructible<T, const U &>::value, "anyCast: T must be constructible from a const lvalue of the stored type");
+    const U *ptr = anyCast<U>(&any);
+    if (!ptr)
+    {
+      throw std::bad_cast();
+    }
+    return static_cast<T>(*ptr);
+  }
+
+  /// @brief Cast a SharedAny object to a T object
+  ///
+  /// The value is cloned if it is shared and T is a non-const reference, other casts only read it.
+  /// @tparam T The type of the value to be casted, may be a reference to access the value without copy
+  /// @param any The SharedAny object to be casted
+  /// @return An object of type T
+  template <typename T>
+  T anyCast(SharedAny &any)
+  {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_constructible<T, const U &>::value)
+    {
+      return anyCast<T>(static_cast<const SharedAny &>(any));
+    }
+    else
+    {
+      static_assert(std::is_constructible<T, U &>::value, "anyCast: T must be constructible from an lvalue of the stored type");
+      U *ptr = anyCast<U>(&any);
+      if (!ptr)
+      {
+        throw std::bad_cast();
+      }
+      return static_cast<T>(*ptr);
+    }
+  }
+
+  /// @brief Cast an rvalue SharedAny object to a T object
+  ///
+  /// The stored value is moved out if it is not shared, copied otherwise.
+  /// @tparam T The type of the value to be casted, must not be a reference
+  /// @param any The SharedAny object to be casted
+  /// @return An object of type T
+  template <typename T>
+  T anyCast(SharedAny &&any)
+  {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    static_assert(!std::is_reference<T>::value, "anyCast: the value of a SharedAny object may be shared, it cannot be accessed by rvalue reference");
+    if (!any.holds<U>())
+    {
+      throw std::bad_cast();
+    }
+    if (!any.isUnique())
+    {
+      return anyCast<T>(static_cast<const SharedAny &>(any));
+    }
+    return static_cast<T>(std::move(*anyCast<U>(&any)));
+  }
+
+} // namespace voc
+
+#endif // VOC_SHARED_ANY_H
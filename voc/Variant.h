@@ -0,0 +1,642 @@
+#ifndef VOC_VARIANT_H
+#define VOC_VARIANT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "Any.h"
+
+namespace voc
+{
+  template <typename... Ts>
+  class Variant;
+
+  namespace details
+  {
+    struct VariantAccess;
+
+    /// @brief Check if a type is a Variant
+    template <typename T>
+    struct IsVariant : std::false_type
+    {
+    };
+
+    template <typename... Ts>
+    struct IsVariant<Variant<Ts...>> : std::true_type
+    {
+    };
+
+    template <typename... Ts>
+    struct IsAnyWrapper<Variant<Ts...>> : std::true_type
+    {
+    };
+
+    /// @brief Find the index of a type in a list of types
+    /// @tparam T The type to find
+    /// @tparam ...Ts The list of types
+    /// @return The index of T, sizeof...(Ts) if it is not in the list
+    template <typename T, typename... Ts>
+    constexpr std::size_t variantIndexOf()
+    {
+      constexpr bool matches[] = {std::is_same<T, Ts>::value..., false};
+      for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+      {
+        if (matches[i])
+        {
+          return i;
+        }
+      }
+      return sizeof...(Ts);
+    }
+
+    /// @brief Count the occurrences of a type in a list of types
+    /// @tparam T The type to count
+    /// @tparam ...Ts The list of types
+    /// @return The number of types of the list that are T
+    template <typename T, typename... Ts>
+    constexpr std::size_t variantCountOf()
+    {
+      return (std::size_t(std::is_same<T, Ts>::value) + ... + 0);
+    }
+
+    /// @brief Smallest unsigned type holding the indexes of Count alternatives and the valueless index
+    template <std::size_t Count>
+    using VariantIndex = std::conditional_t<(Count <= 0xFF), std::uint8_t, std::uint16_t>;
+
+    /// @brief Operations on the alternatives of Variant, in tables indexed by the index of the alternative
+    ///
+    /// The tables are only instantiated when used, so that the copy tables do not require
+    /// the alternatives to be copyable if Variant is never copied.
+    /// @tparam ...Ts The alternatives
+    template <typename... Ts>
+    struct VariantHandler
+    {
+      /// @brief Destroy a value
+      template <typename T>
+      static void destroy(void *data) noexcept
+      {
+        static_cast<T *>(data)->~T();
+      }
+
+      /// @brief Copy construct a value in uninitialized storage
+      template <typename T>
+      static void copy(const void *src, void *dst)
+      {
+        new (dst) T(*static_cast<const T *>(src));
+      }
+
+      /// @brief Move construct a value in uninitialized storage
+      template <typename T>
+      static void move(void *src, void *dst)
+      {
+        new (dst) T(std::move(*static_cast<T *>(src)));
+      }
+
+      /// @brief Copy assign a value to a value of the same type
+      template <typename T>
+      static void copyAssign(const void *src, void *dst)
+      {
+        *static_cast<T *>(dst) = *static_cast<const T *>(src);
+      }
+
+      /// @brief Move assign a value to a value of the same type
+      template <typename T>
+      static void moveAssign(void *src, void *dst)
+      {
+        *static_cast<T *>(dst) = std::move(*static_cast<T *>(src));
+      }
+
+      static constexpr std::array<void (*)(void *), sizeof...(Ts)> Destroy = {&destroy<Ts>...};          ///< The destructors
+      static constexpr std::array<void (*)(const void *, void *), sizeof...(Ts)> Copy = {&copy<Ts>...};   ///< The copy constructors
+      static constexpr std::array<void (*)(void *, void *), sizeof...(Ts)> Move = {&move<Ts>...};         ///< The move constructors
+      static constexpr std::array<void (*)(const void *, void *), sizeof...(Ts)> CopyAssign = {&copyAssign<Ts>...}; ///< The copy assignments
+      static constexpr std::array<void (*)(void *, void *), sizeof...(Ts)> MoveAssign = {&moveAssign<Ts>...};       ///< The move assignments
+    };
+
+    /// @brief Storage of Variant, a buffer for the largest alternative and the index
+    ///
+    /// The destructor is trivial if all the alternatives are trivially destructible.
+    /// @tparam TriviallyDestructible Whether all the alternatives are trivially destructible
+    /// @tparam ...Ts The alternatives
+    template <bool TriviallyDestructible, typename... Ts>
+    struct VariantStorage
+    {
+      using Index = VariantIndex<sizeof...(Ts)>;                ///< The type of the index
+      static constexpr Index Valueless = Index(sizeof...(Ts)); ///< The index when there is no value
+
+      /// @brief Default constructor, no value
+      VariantStorage() = default;
+
+      /// @brief Copy constructor, defined by VariantOperations
+      VariantStorage(const VariantStorage &) = default;
+
+      /// @brief Move constructor, defined by VariantOperations
+      VariantStorage(VariantStorage &&) = default;
+
+      /// @brief Copy assignment operator, defined by VariantOperations
+      VariantStorage &operator=(const VariantStorage &) = default;
+
+      /// @brief Move assignment operator, defined by VariantOperations
+      VariantStorage &operator=(VariantStorage &&) = default;
+
+      /// @brief Destructor
+      ~VariantStorage()
+      {
+        destroy();
+      }
+
+      /// @brief Destroy the value if there is one
+      void destroy() noexcept
+      {
+        if (current != Valueless)
+        {
+          VariantHandler<Ts...>::Destroy[current](data);
+          current = Valueless;
+        }
+      }
+
+      alignas(Ts...) unsigned char data[std::max({sizeof(Ts)...})]; ///< The stored value
+      Index current = Valueless;                                     ///< The index of the stored alternative
+    };
+
+    template <typename... Ts>
+    struct VariantStorage<true, Ts...>
+    {
+      using Index = VariantIndex<sizeof...(Ts)>;                ///< The type of the index
+      static constexpr Index Valueless = Index(sizeof...(Ts)); ///< The index when there is no value
+
+      /// @brief Forget the value, it has nothing to destroy
+      void destroy() noexcept
+      {
+        current = Valueless;
+      }
+
+      alignas(Ts...) unsigned char data[std::max({sizeof(Ts)...})]; ///< The stored value
+      Index current = Valueless;                                     ///< The index of the stored alternative
+    };
+
+    /// @brief Copy and move operations of Variant
+    ///
+    /// If all the alternatives are trivially copyable, they are all defaulted and trivial, so that
+    /// Variant is trivially copyable too. Otherwise they dispatch on the index through VariantHandler.
+    /// A moved-from Variant keeps its alternative, in a moved-from state.
+    /// @tparam TriviallyCopyable Whether all the alternatives are trivially copyable
+    /// @tparam ...Ts The alternatives
+    template <bool TriviallyCopyable, typename... Ts>
+    struct VariantOperations : VariantStorage<(std::is_trivially_destructible<Ts>::value && ...), Ts...>
+    {
+    };
+
+    template <typename... Ts>
+    struct VariantOperations<false, Ts...> : VariantStorage<(std::is_trivially_destructible<Ts>::value && ...), Ts...>
+    {
+      using Storage = VariantStorage<(std::is_trivially_destructible<Ts>::value && ...), Ts...>;
+      using Handler = VariantHandler<Ts...>;
+
+      /// @brief Default constructor, no value
+      VariantOperations() = default;
+
+      /// @brief Copy constructor
+      /// @param other The other object to be copied
+      VariantOperations(const VariantOperations &other) : Storage()
+      {
+        if (other.current != Storage::Valueless)
+        {
+          Handler::Copy[other.current](other.data, this->data);
+          this->current = other.current;
+        }
+      }
+
+      /// @brief Move constructor
+      /// @param other The other object to be moved
+      VariantOperations(VariantOperations &&other) noexcept((std::is_nothrow_move_constructible<Ts>::value && ...)) : Storage()
+      {
+        if (other.current != Storage::Valueless)
+        {
+          Handler::Move[other.current](other.data, this->data);
+          this->current = other.current;
+        }
+      }
+
+      /// @brief Copy assignment operator
+      ///
+      /// The value is assigned if both objects hold the same alternative, otherwise it is
+      /// destroyed and copy constructed, the object is left valueless if the copy throws.
+      /// @param other The other object to be copied
+      /// @return A reference to the current object
+      VariantOperations &operator=(const VariantOperations &other)
+      {
+        if (this == &other)
+        {
+          return *this;
+        }
+        if (other.current == Storage::Valueless)
+        {
+          this->destroy();
+        }
+        else if (this->current == other.current)
+        {
+          Handler::CopyAssign[this->current](other.data, this->data);
+        }
+        else
+        {
+          this->destroy();
+          Handler::Copy[other.current](other.data, this->data);
+          this->current = other.current;
+        }
+        return *this;
+      }
+
+      /// @brief Move assignment operator
+      /// @param other The other object to be moved
+      /// @return A reference to the current object
+      VariantOperations &operator=(VariantOperations &&other) noexcept(((std::is_nothrow_move_constructible<Ts>::value && std::is_nothrow_move_assignable<Ts>::value) && ...))
+      {
+        if (this == &other)
+        {
+          return *this;
+        }
+        if (other.current == Storage::Valueless)
+        {
+          this->destroy();
+        }
+        else if (this->current == other.current)
+        {
+          Handler::MoveAssign[this->current](other.data, this->data);
+        }
+        else
+        {
+          this->destroy();
+          Handler::Move[other.current](other.data, this->data);
+          this->current = other.current;
+        }
+        return *this;
+      }
+
+      /// @brief Destructor
+      ~VariantOperations() = default;
+    };
+
+    /// @brief Delete the copy and move operations of Variant that some alternative does not support
+    /// @tparam Copyable Whether all the alternatives are copy constructible
+    /// @tparam Movable Whether all the alternatives are move constructible
+    template <bool Copyable, bool Movable>
+    struct VariantCopyControl
+    {
+    };
+
+    template <>
+    struct VariantCopyControl<false, true>
+    {
+      VariantCopyControl() = default;
+      VariantCopyControl(const VariantCopyControl &) = delete;
+      VariantCopyControl(VariantCopyControl &&) = default;
+      VariantCopyControl &operator=(const VariantCopyControl &) = delete;
+      VariantCopyControl &operator=(VariantCopyControl &&) = default;
+    };
+
+    template <>
+    struct VariantCopyControl<false, false>
+    {
+      VariantCopyControl() = default;
+      VariantCopyControl(const VariantCopyControl &) = delete;
+      VariantCopyControl(VariantCopyControl &&) = delete;
+      VariantCopyControl &operator=(const VariantCopyControl &) = delete;
+      VariantCopyControl &operator=(VariantCopyControl &&) = delete;
+    };
+
+    /// @brief Access to the alternatives of a Variant object, without checking the index
+    struct VariantAccess
+    {
+      /// @brief Get an alternative
+      /// @tparam I The index of the alternative, must be the index of the stored alternative
+      /// @param variant The Variant object
+      /// @return A reference to the stored value
+      template <std::size_t I, typename... Ts>
+      static auto &get(Variant<Ts...> &variant) noexcept
+      {
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        return *std::launder(reinterpret_cast<T *>(variant.data));
+      }
+
+      /// @brief Get an alternative
+      /// @tparam I The index of the alternative, must be the index of the stored alternative
+      /// @param variant The Variant object
+      /// @return A const reference to the stored value
+      template <std::size_t I, typename... Ts>
+      static const auto &get(const Variant<Ts...> &variant) noexcept
+      {
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        return *std::launder(reinterpret_cast<const T *>(variant.data));
+      }
+    };
+
+    /// @brief Table of the functions calling a visitor on the value of a Variant object
+    ///
+    /// The last entry is called when the Variant object is valueless.
+    /// @tparam R The return type of the visitor
+    /// @tparam Visitor The type of the visitor
+    /// @tparam VariantRef The reference to the Variant object
+    /// @tparam ...Ts The alternatives
+    template <typename R, typename Visitor, typename VariantRef, typename... Ts>
+    struct VariantVisitTable
+    {
+      /// @brief Call the visitor with one alternative
+      /// @tparam I The index of the alternative
+      template <std::size_t I>
+      static R call(Visitor &visitor, VariantRef variant)
+      {
+        return static_cast<R>(std::invoke(visitor, VariantAccess::get<I>(variant)));
+      }
+
+      /// @brief Called when there is no value
+      static R valueless(Visitor &, VariantRef)
+      {
+        throw std::bad_cast();
+      }
+
+      /// @brief Build the table
+      template <std::size_t... I>
+      static constexpr std::array<R (*)(Visitor &, VariantRef), sizeof...(I) + 1> make(std::index_sequence<I...>)
+      {
+        return {&call<I>..., &valueless};
+      }
+
+      static constexpr auto Functions = make(std::index_sequence_for<Ts...>()); ///< The table
+    };
+
+    /// @brief Visit a Variant object
+    template <typename Visitor, typename... Ts>
+    decltype(auto) visitVariant(Variant<Ts...> &variant, Visitor &visitor)
+    {
+      using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+      using R = std::invoke_result_t<Visitor &, First &>;
+      return VariantVisitTable<R, Visitor, Variant<Ts...> &, Ts...>::Functions[variant.index()](visitor, variant);
+    }
+
+    /// @brief Visit a const Variant object
+    template <typename Visitor, typename... Ts>
+    decltype(auto) visitVariant(const Variant<Ts...> &variant, Visitor &visitor)
+    {
+      using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+      using R = std::invoke_result_t<Visitor &, const First &>;
+      return VariantVisitTable<R, Visitor, const Variant<Ts...> &, Ts...>::Functions[variant.index()](visitor, variant);
+    }
+  }
+
+  /// @brief Class to store a value of one of a fixed list of types
+  ///
+  /// The value is always stored inline, in a buffer sized and aligned for the largest alternative,
+  /// with the smallest index type able to hold the number of alternatives. Variant is trivially
+  /// copyable if all the alternatives are, and trivially destructible if they all are.
+  /// If constructing a new alternative throws, the Variant object is left valueless.
+  /// @tparam ...Ts The alternatives, distinct non-reference object types
+  template <typename... Ts>
+  class Variant : private details::VariantOperations<(std::is_trivially_copyable<Ts>::value && ...), Ts...>,
+                  private details::VariantCopyControl<(std::is_copy_constructible<Ts>::value && ...), (std::is_move_constructible<Ts>::value && ...)>
+  {
+  private:
+    static_assert(sizeof...(Ts) > 0, "Variant: the list of alternatives must not be empty");
+    static_assert(((std::is_object<Ts>::value && !std::is_array<Ts>::value && std::is_same<Ts, std::remove_cv_t<Ts>>::value) && ...), "Variant: the alternatives must be non-const, non-array object types");
+    static_assert(((details::variantCountOf<Ts, Ts...>() == 1) && ...), "Variant: the alternatives must be distinct");
+
+    using Base = details::VariantOperations<(std::is_trivially_copyable<Ts>::value && ...), Ts...>;
+    using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+
+    /// @brief Index of a type in the list of alternatives
+    template <typename T>
+    static constexpr std::size_t IndexOf = details::variantIndexOf<T, Ts...>();
+
+    /// @brief Construct an alternative, there must be no value
+    template <typename T, typename... Args>
+    T &construct(Args &&...args)
+    {
+      T *value = new (this->data) T(std::forward<Args>(args)...);
+      this->current = static_cast<typename Base::Index>(IndexOf<T>);
+      return *value;
+    }
+
+    friend struct details::VariantAccess;
+
+  public:
+    /// @brief The index of a valueless Variant object
+    static constexpr std::size_t npos = sizeof...(Ts);
+
+    /// @brief Default constructor, the first alternative is value-initialized
+    template <typename U = First, typename std::enable_if<std::is_default_constructible<U>::value>::type * = nullptr>
+    Variant() noexcept(std::is_nothrow_default_constructible<First>::value)
+    {
+      construct<First>();
+    }
+
+    /// @brief Constructor from a value, its type must be one of the alternatives
+    /// @tparam T The type of the value to be stored
+    /// @param value The value to be stored
+    template <typename T, typename std::enable_if<!details::IsVariant<std::decay_t<T>>::value && (details::variantIndexOf<std::decay_t<T>, Ts...>() < sizeof...(Ts))>::type * = nullptr>
+    Variant(T &&value) noexcept(std::is_nothrow_constructible<std::decay_t<T>, T>::value)
+    {
+      construct<std::decay_t<T>>(std::forward<T>(value));
+    }
+
+    /// @brief Constructor from a value and a type struct
+    /// @tparam T The type of the value to be stored, must be one of the alternatives
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param type The type struct
+    /// @param ...args The arguments to be passed to the constructor of T
+    template <typename T, typename... Args>
+    Variant(InPlaceTypeStruct<T>, Args &&...args)
+    {
+      static_assert(IndexOf<T> < sizeof...(Ts), "Variant: T must be one of the alternatives");
+      construct<T>(std::forward<Args>(args)...);
+    }
+
+    /// @brief Assignment from a value, its type must be one of the alternatives
+    ///
+    /// The value is assigned if it has the type of the stored alternative, otherwise the stored
+    /// value is destroyed and replaced.
+    /// @tparam T The type of the value to be stored
+    /// @param value The value to be stored
+    /// @return A reference to the current object
+    template <typename T, typename std::enable_if<!details::IsVariant<std::decay_t<T>>::value && (details::variantIndexOf<std::decay_t<T>, Ts...>() < sizeof...(Ts))>::type * = nullptr>
+    Variant &operator=(T &&value)
+    {
+      using U = std::decay_t<T>;
+      if (holds<U>())
+      {
+        details::VariantAccess::get<IndexOf<U>>(*this) = std::forward<T>(value);
+      }
+      else
+      {
+        emplace<U>(std::forward<T>(value));
+      }
+      return *this;
+    }
+
+    /// @brief Get the index of the stored alternative
+    /// @return The index of the stored alternative, npos if the Variant object is valueless
+    std::size_t index() const noexcept
+    {
+      return this->current;
+    }
+
+    /// @brief Check if the Variant object has no value, which only happens if an emplace threw
+    /// @return true if the Variant object has no value, false otherwise
+    bool isValueless() const noexcept
+    {
+      return this->current == Base::Valueless;
+    }
+
+    /// @brief Check if the Variant object stores a value of type T
+    /// @tparam T The type to check
+    /// @return true if the stored alternative is T, false otherwise
+    template <typename T>
+    bool holds() const noexcept
+    {
+      static_assert(IndexOf<T> < sizeof...(Ts), "Variant: T must be one of the alternatives");
+      return this->current == IndexOf<T>;
+    }
+
+    /// @brief Get a pointer to the stored value
+    /// @tparam T The type of the value, must be one of the alternatives
+    /// @return A pointer to the stored value, nullptr if it is not of type T
+    template <typename T>
+    T *getIf() noexcept
+    {
+      return holds<T>() ? &details::VariantAccess::get<IndexOf<T>>(*this) : nullptr;
+    }
+
+    /// @brief Get a const pointer to the stored value
+    /// @tparam T The type of the value, must be one of the alternatives
+    /// @return A const pointer to the stored value, nullptr if it is not of type T
+    template <typename T>
+    const T *getIf() const noexcept
+    {
+      return holds<T>() ? &details::VariantAccess::get<IndexOf<T>>(*this) : nullptr;
+    }
+
+    /// @brief Get the stored value
+    /// @tparam T The type of the value, must be one of the alternatives
+    /// @return A reference to the stored value, throws std::bad_cast if it is not of type T
+    template <typename T>
+    T &get() &
+    {
+      if (!holds<T>())
+      {
+        throw std::bad_cast();
+      }
+      return details::VariantAccess::get<IndexOf<T>>(*this);
+    }
+
+    /// @brief Get the stored value
+    /// @tparam T The type of the value, must be one of the alternatives
+    /// @return A const reference to the stored value, throws std::bad_cast if it is not of type T
+    template <typename T>
+    const T &get() const &
+    {
+      if (!holds<T>())
+      {
+        throw std::bad_cast();
+      }
+      return details::VariantAccess::get<IndexOf<T>>(*this);
+    }
+
+    /// @brief Get the stored value of an rvalue Variant object
+    /// @tparam T The type of the value, must be one of the alternatives
+    /// @return An rvalue reference to the stored value, throws std::bad_cast if it is not of type T
+    template <typename T>
+    T &&get() &&
+    {
+      return std::move(get<T>());
+    }
+
+    /// @brief Replace the stored value by a value constructed in place
+    ///
+    /// The Variant object is left valueless if the constructor of T throws.
+    /// @tparam T The type of the value to be stored, must be one of the alternatives
+    /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+    /// @param ...args The arguments to be passed to the constructor of T
+    /// @return A reference to the new stored value
+    template <typename T, typename... Args>
+    T &emplace(Args &&...args)
+    {
+      static_assert(IndexOf<T> < sizeof...(Ts), "Variant: T must be one of the alternatives");
+      this->destroy();
+      return construct<T>(std::forward<Args>(args)...);
+    }
+
+    /// @brief Swap with another Variant object
+    /// @param other The other Variant object
+    void swap(Variant &other)
+    {
+      Variant tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+
+    /// @brief Get the identifier of the stored type
+    /// @return The identifier of the stored type, typeId<void>() if the Variant object is valueless
+    TypeId getTypeId() const noexcept
+    {
+      static constexpr std::array<TypeId, sizeof...(Ts) + 1> Ids = {voc::typeId<Ts>()..., voc::typeId<void>()};
+      return Ids[this->current];
+    }
+
+    /// @brief Conversion to an Any object, the value is copied
+    /// @return An Any object storing a copy of the value, empty if the Variant object is valueless
+    explicit operator Any() const &
+    {
+      if (isValueless())
+      {
+        return Any();
+      }
+      return visit(*this, [](const auto &value) { return Any(value); });
+    }
+
+    /// @brief Conversion to an Any object, the value is moved
+    /// @return An Any object storing the value, empty if the Variant object is valueless
+    explicit operator Any() &&
+    {
+      if (isValueless())
+      {
+        return Any();
+      }
+      return visit(*this, [](auto &value) { return Any(std::move(value)); });
+    }
+  };
+
+  /// @brief Call a visitor with the value stored in a Variant object
+  ///
+  /// The visitor is called through a table of functions indexed by the index of the alternative,
+  /// it must accept all the alternatives. std::bad_cast is thrown if the Variant object is valueless.
+  /// @param variant The Variant object
+  /// @param visitor The visitor, called with a reference to the stored value
+  /// @return The result of the visitor, converted to its result for the first alternative
+  template <typename VariantType, typename Visitor, typename std::enable_if<details::IsVariant<std::remove_const_t<VariantType>>::value>::type * = nullptr>
+  decltype(auto) visit(VariantType &variant, Visitor &&visitor)
+  {
+    return details::visitVariant(variant, visitor);
+  }
+
+  /// @brief Create a Variant object from a value
+  /// @tparam V The type of the Variant object
+  /// @tparam T The type of the value to be stored, must be one of the alternatives
+  /// @tparam ...Args The type of the arguments to be passed to the constructor of T
+  /// @param ...args The arguments to be passed to the constructor of T
+  /// @return A Variant object storing the value
+  template <typename V, typename T, typename... Args>
+  V makeVariant(Args &&...args)
+  {
+    return V(InPlaceType<T>, std::forward<Args>(args)...);
+  }
+
+} // namespace voc
+
+#endif // VOC_VARIANT_H
@@ -0,0 +1,1035 @@
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "Any.h"
+#include "AnyColumns.h"
+#include "AnyQueue.h"
+#include "AnyVisit.h"
+#include "AtomicAny.h"
+#include "AtomicOptional.h"
+#include "Optional.h"
+#include "OptionalArray.h"
+#include "OptionalReductions.h"
+#include "SharedAny.h"
+
+/****************************
+ * ALLOCATION COUNTER       *
+ ****************************/
+
+namespace
+{
+  std::atomic<std::size_t> allocationCount{0}; ///< Number of calls to the global operator new
+
+  /// @brief Report the allocations done during the timed loop, per iteration
+  ///
+  /// Construct it just before the loop and call report() right after it.
+  class AllocationReporter
+  {
+  public:
+    /// @brief Constructor, start counting
+    /// @param state The benchmark state
+    explicit AllocationReporter(benchmark::State &state) : state(state), before(allocationCount.load(std::memory_order_relaxed)) {}
+
+    /// @brief Add the "allocs" counter, the number of allocations per iteration
+    void report()
+    {
+      std::size_t allocations = allocationCount.load(std::memory_order_relaxed) - before;
+      state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    }
+
+  private:
+    benchmark::State &state; ///< The benchmark state
+    std::size_t before;      ///< The number of allocations before the loop
+  };
+}
+
+// The replacements are inlined at -O2, GCC then sees new paired with free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size)
+{
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/*****************************
+ * BENCHMARKS FOR ANYCOLUMNS *
+ *****************************/
+
+namespace
+{
+  /// @brief Create the mixed values of the benchmarks: ints, doubles and strings
+  /// @param count The number of values
+  /// @return The values
+  std::vector<voc::Any> makeMixedValues(std::size_t count)
+  {
+    std::vector<voc::Any> values;
+    values.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      switch (i % 3)
+      {
+      case 0:
+        values.emplace_back(static_cast<int>(i));
+        break;
+      case 1:
+        values.emplace_back(static_cast<double>(i));
+        break;
+      default:
+        values.emplace_back(std::string("value"));
+        break;
+      }
+    }
+    return values;
+  }
+}
+
+static void BM_VectorOfAny_SumInts(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    long long sum = 0;
+    for (const voc::Any &any : values)
+    {
+      if (const int *value = voc::anyCast<int>(&any))
+      {
+        sum += *value;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorOfAny_SumInts)->Range(1 << 10, 1 << 20);
+
+static void BM_AnyColumns_SumInts(benchmark::State &state)
+{
+  voc::AnyColumns columns;
+  columns.registerType<int>();
+  columns.registerType<double>();
+  columns.registerType<std::string>();
+  for (voc::Any &any : makeMixedValues(state.range(0)))
+  {
+    columns.pushBack(std::move(any));
+  }
+  for (auto _ : state)
+  {
+    long long sum = 0;
+    columns.forEachOfType<int>([&](int value) { sum += value; });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyColumns_SumInts)->Range(1 << 10, 1 << 20);
+
+static void BM_AnyColumns_PushBack(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    voc::AnyColumns columns;
+    columns.registerType<int>();
+    columns.registerType<double>();
+    columns.registerType<std::string>();
+    for (const voc::Any &any : values)
+    {
+      columns.pushBack(any);
+    }
+    benchmark::DoNotOptimize(columns.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyColumns_PushBack)->Range(1 << 10, 1 << 16);
+
+/****************************
+ * BENCHMARKS FOR VISIT     *
+ ****************************/
+
+#if VOC_HAS_RTTI
+static void BM_TypeidChain(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (const voc::Any &any : values)
+    {
+      if (any.getType() == typeid(int))
+      {
+        sum += voc::anyCast<const int &>(any);
+      }
+      else if (any.getType() == typeid(double))
+      {
+        sum += voc::anyCast<const double &>(any);
+      }
+      else if (any.getType() == typeid(std::string))
+      {
+        sum += voc::anyCast<const std::string &>(any).size();
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TypeidChain)->Range(1 << 10, 1 << 16);
+#endif
+
+static void BM_Visit(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (const voc::Any &any : values)
+    {
+      voc::visit<int, double, std::string>(any, [&](const auto &value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same<T, std::string>::value)
+        {
+          sum += value.size();
+        }
+        else if constexpr (std::is_arithmetic<T>::value)
+        {
+          sum += value;
+        }
+      });
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Visit)->Range(1 << 10, 1 << 16);
+
+/****************************
+ * BENCHMARKS FOR SHAREDANY *
+ ****************************/
+
+static void BM_FanOut_Any(benchmark::State &state)
+{
+  voc::Any payload = std::vector<int>(state.range(0), 42);
+  std::vector<voc::Any> subscribers(16);
+  for (auto _ : state)
+  {
+    for (voc::Any &subscriber : subscribers)
+    {
+      subscriber = payload;
+    }
+    benchmark::DoNotOptimize(subscribers.data());
+  }
+  state.SetItemsProcessed(state.iterations() * subscribers.size());
+}
+BENCHMARK(BM_FanOut_Any)->Range(1 << 4, 1 << 14);
+
+static void BM_FanOut_SharedAny(benchmark::State &state)
+{
+  voc::SharedAny payload = std::vector<int>(state.range(0), 42);
+  std::vector<voc::SharedAny> subscribers(16);
+  for (auto _ : state)
+  {
+    for (voc::SharedAny &subscriber : subscribers)
+    {
+      subscriber = payload;
+    }
+    benchmark::DoNotOptimize(subscribers.data());
+  }
+  state.SetItemsProcessed(state.iterations() * subscribers.size());
+}
+BENCHMARK(BM_FanOut_SharedAny)->Range(1 << 4, 1 << 14);
+
+/********************************
+ * BENCHMARKS FOR OPTIONALARRAY *
+ ********************************/
+
+static void BM_VectorOfOptional_FillNulls(benchmark::State &state)
+{
+  std::vector<voc::Optional<double>> values(state.range(0));
+  for (std::size_t i = 0; i < values.size(); i += 3)
+  {
+    values[i] = static_cast<double>(i);
+  }
+  std::vector<double> filled(values.size());
+  for (auto _ : state)
+  {
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      filled[i] = values[i].getValueOr(0.0);
+    }
+    benchmark::DoNotOptimize(filled.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VectorOfOptional_FillNulls)->Range(1 << 10, 1 << 20);
+
+static void BM_OptionalArray_FillNulls(benchmark::State &state)
+{
+  voc::OptionalArray<double> values;
+  for (std::size_t i = 0; i < static_cast<std::size_t>(state.range(0)); ++i)
+  {
+    if (i % 3 == 0)
+    {
+      values.pushBack(static_cast<double>(i));
+    }
+    else
+    {
+      values.pushNull();
+    }
+  }
+  std::vector<double> filled(values.size());
+  for (auto _ : state)
+  {
+    values.getValuesOr(0.0, filled.data());
+    benchmark::DoNotOptimize(filled.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OptionalArray_FillNulls)->Range(1 << 10, 1 << 20);
+
+static void BM_OptionalArray_CountValues(benchmark::State &state)
+{
+  voc::OptionalArray<double> values;
+  for (std::size_t i = 0; i < static_cast<std::size_t>(state.range(0)); ++i)
+  {
+    if (i % 3 == 0)
+    {
+      values.pushBack(static_cast<double>(i));
+    }
+    else
+    {
+      values.pushNull();
+    }
+  }
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(values.countValues());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OptionalArray_CountValues)->Range(1 << 10, 1 << 20);
+
+/*************************************
+ * BENCHMARKS FOR MASKED REDUCTIONS  *
+ *************************************/
+
+namespace
+{
+  /// @brief Number of values of the reduction benchmarks
+  constexpr std::size_t ReductionCount = 10000000;
+
+  /// @brief Get the values of the reduction benchmarks, half of them present at random
+  /// @return The values
+  const voc::OptionalArray<double> &reductionValues()
+  {
+    static const voc::OptionalArray<double> values = []() {
+      std::mt19937 generator(42);
+      voc::OptionalArray<double> result;
+      result.reserve(ReductionCount);
+      for (std::size_t i = 0; i < ReductionCount; ++i)
+      {
+        if (generator() % 2 == 0)
+        {
+          result.pushBack(static_cast<double>(generator() % 1000));
+        }
+        else
+        {
+          result.pushNull();
+        }
+      }
+      return result;
+    }();
+    return values;
+  }
+}
+
+static void BM_VectorOfOptional_Sum(benchmark::State &state)
+{
+  const voc::OptionalArray<double> &array = reductionValues();
+  std::vector<voc::Optional<double>> values(array.size());
+  for (std::size_t i = 0; i < array.size(); ++i)
+  {
+    values[i] = array[i];
+  }
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (const voc::Optional<double> &value : values)
+    {
+      if (value.hasValue())
+      {
+        sum += *value;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_VectorOfOptional_Sum)->Unit(benchmark::kMillisecond);
+
+static void BM_MaskedSum(benchmark::State &state)
+{
+  const voc::OptionalArray<double> &array = reductionValues();
+  voc::SimdLevel level = static_cast<voc::SimdLevel>(state.range(0));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(voc::maskedSum(array.data(), array.bitmap(), array.size(), level));
+  }
+  state.SetItemsProcessed(state.iterations() * array.size());
+}
+BENCHMARK(BM_MaskedSum)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_MaskedMin(benchmark::State &state)
+{
+  const voc::OptionalArray<double> &array = reductionValues();
+  voc::SimdLevel level = static_cast<voc::SimdLevel>(state.range(0));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(voc::maskedMin(array.data(), array.bitmap(), array.size(), level));
+  }
+  state.SetItemsProcessed(state.iterations() * array.size());
+}
+BENCHMARK(BM_MaskedMin)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_MaskedCoalesce(benchmark::State &state)
+{
+  const voc::OptionalArray<double> &array = reductionValues();
+  voc::SimdLevel level = static_cast<voc::SimdLevel>(state.range(0));
+  std::vector<double> out(array.size());
+  for (auto _ : state)
+  {
+    voc::maskedCoalesce(array.data(), array.bitmap(), array.size(), 0.0, out.data(), level);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * array.size());
+}
+BENCHMARK(BM_MaskedCoalesce)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+/****************************
+ * BENCHMARKS FOR TRYCAST   *
+ ****************************/
+
+static void BM_ProbeWithAnyCast(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (voc::Any &any : values)
+    {
+      try
+      {
+        sum += voc::anyCast<int>(any);
+      }
+      catch (const std::bad_cast &)
+      {
+        try
+        {
+          sum += voc::anyCast<double>(any);
+        }
+        catch (const std::bad_cast &)
+        {
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProbeWithAnyCast)->Range(1 << 10, 1 << 14);
+
+static void BM_ProbeWithTryCast(benchmark::State &state)
+{
+  std::vector<voc::Any> values = makeMixedValues(state.range(0));
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (voc::Any &any : values)
+    {
+      if (voc::Optional<int &> value = voc::tryCast<int>(any))
+      {
+        sum += *value;
+      }
+      else if (voc::Optional<double &> value = voc::tryCast<double>(any))
+      {
+        sum += *value;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProbeWithTryCast)->Range(1 << 10, 1 << 14);
+
+/********************************************
+ * BENCHMARKS AGAINST THE STANDARD LIBRARY  *
+ ********************************************/
+
+// Each benchmark is instantiated for voc::Any or voc::Optional and for its std counterpart,
+// with payloads of several sizes. voc::Any stores up to 3 pointers inline, libstdc++
+// std::any only 1. The "allocs" counter is the number of allocations per iteration.
+
+namespace
+{
+  /// @brief Trivially copyable payload of N bytes
+  template <std::size_t N>
+  struct Payload
+  {
+    unsigned char bytes[N];
+  };
+
+  /// @brief Create a payload
+  /// @param seed The value of the first byte
+  template <typename T>
+  T makePayload(unsigned char seed)
+  {
+    T payload{};
+    payload.bytes[0] = seed;
+    return payload;
+  }
+
+  /// @brief Cast a voc::Any object to a const T pointer
+  template <typename T>
+  const T *castPointer(const voc::Any &any)
+  {
+    return voc::anyCast<T>(&any);
+  }
+
+  /// @brief Cast a std::any object to a const T pointer
+  template <typename T>
+  const T *castPointer(const std::any &any)
+  {
+    return std::any_cast<T>(&any);
+  }
+
+#if VOC_HAS_RTTI
+  /// @brief Get the type of the value of a voc::Any object
+  const std::type_info &typeOf(const voc::Any &any)
+  {
+    return any.getType();
+  }
+
+  /// @brief Get the type of the value of a std::any object
+  const std::type_info &typeOf(const std::any &any)
+  {
+    return any.type();
+  }
+#endif
+
+  /// @brief Get the value of a voc::Optional object or a default value
+  template <typename T>
+  T valueOr(const voc::Optional<T> &optional, const T &defaultValue)
+  {
+    return optional.getValueOr(defaultValue);
+  }
+
+  /// @brief Get the value of a std::optional object or a default value
+  template <typename T>
+  T valueOr(const std::optional<T> &optional, const T &defaultValue)
+  {
+    return optional.value_or(defaultValue);
+  }
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_ConstructDestroy(benchmark::State &state)
+{
+  T payload = makePayload<T>(42);
+  AllocationReporter allocations(state);
+  for (auto _ : state)
+  {
+    AnyType any(payload);
+    benchmark::DoNotOptimize(&any);
+  }
+  allocations.report();
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_Copy(benchmark::State &state)
+{
+  AnyType source(makePayload<T>(42));
+  AllocationReporter allocations(state);
+  for (auto _ : state)
+  {
+    AnyType copy(source);
+    benchmark::DoNotOptimize(&copy);
+  }
+  allocations.report();
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_Move(benchmark::State &state)
+{
+  AnyType first(makePayload<T>(42));
+  AllocationReporter allocations(state);
+  for (auto _ : state)
+  {
+    AnyType second(std::move(first));
+    first = std::move(second);
+    benchmark::DoNotOptimize(&first);
+  }
+  allocations.report();
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_CastHit(benchmark::State &state)
+{
+  AnyType any(makePayload<T>(42));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(any);
+    benchmark::DoNotOptimize(castPointer<T>(any));
+  }
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_CastMiss(benchmark::State &state)
+{
+  AnyType any(makePayload<T>(42));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(any);
+    benchmark::DoNotOptimize(castPointer<double>(any));
+  }
+}
+
+template <typename AnyType, typename T>
+static void BM_Any_IterateVector(benchmark::State &state)
+{
+  std::vector<AnyType> values;
+  for (int i = 0; i < 1024; ++i)
+  {
+    values.emplace_back(makePayload<T>(static_cast<unsigned char>(i)));
+  }
+  for (auto _ : state)
+  {
+    unsigned sum = 0;
+    for (const AnyType &any : values)
+    {
+      sum += castPointer<T>(any)->bytes[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+/// @brief Register a benchmark for voc::Any and std::any, with payloads of 8 to 256 bytes
+#define VOC_BENCHMARK_ANY_PAYLOADS(func)                   \
+  BENCHMARK_TEMPLATE(func, voc::Any, Payload<8>);          \
+  BENCHMARK_TEMPLATE(func, std::any, Payload<8>);          \
+  BENCHMARK_TEMPLATE(func, voc::Any, Payload<24>);         \
+  BENCHMARK_TEMPLATE(func, std::any, Payload<24>);         \
+  BENCHMARK_TEMPLATE(func, voc::Any, Payload<64>);         \
+  BENCHMARK_TEMPLATE(func, std::any, Payload<64>);         \
+  BENCHMARK_TEMPLATE(func, voc::Any, Payload<256>);        \
+  BENCHMARK_TEMPLATE(func, std::any, Payload<256>)
+
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_ConstructDestroy);
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_Copy);
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_Move);
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_CastHit);
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_CastMiss);
+VOC_BENCHMARK_ANY_PAYLOADS(BM_Any_IterateVector);
+
+#if VOC_HAS_RTTI
+template <typename AnyType>
+static void BM_Any_GetTypeDispatch(benchmark::State &state)
+{
+  std::vector<AnyType> values;
+  for (int i = 0; i < 1024; ++i)
+  {
+    switch (i % 3)
+    {
+    case 0:
+      values.emplace_back(i);
+      break;
+    case 1:
+      values.emplace_back(static_cast<double>(i));
+      break;
+    default:
+      values.emplace_back(makePayload<Payload<64>>(static_cast<unsigned char>(i)));
+      break;
+    }
+  }
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (const AnyType &any : values)
+    {
+      const std::type_info &type = typeOf(any);
+      if (type == typeid(int))
+      {
+        sum += *castPointer<int>(any);
+      }
+      else if (type == typeid(double))
+      {
+        sum += *castPointer<double>(any);
+      }
+      else if (type == typeid(Payload<64>))
+      {
+        sum += castPointer<Payload<64>>(any)->bytes[0];
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK_TEMPLATE(BM_Any_GetTypeDispatch, voc::Any);
+BENCHMARK_TEMPLATE(BM_Any_GetTypeDispatch, std::any);
+#endif
+
+template <typename OptionalType, typename T>
+static void BM_Optional_GetValueOr(benchmark::State &state)
+{
+  std::vector<OptionalType> values(1024);
+  for (std::size_t i = 0; i < values.size(); i += 2)
+  {
+    values[i] = makePayload<T>(static_cast<unsigned char>(i));
+  }
+  T defaultValue = makePayload<T>(1);
+  for (auto _ : state)
+  {
+    unsigned sum = 0;
+    for (const OptionalType &optional : values)
+    {
+      sum += valueOr(optional, defaultValue).bytes[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template <typename OptionalType, typename T>
+static void BM_Optional_Copy(benchmark::State &state)
+{
+  std::vector<OptionalType> source(1024);
+  for (std::size_t i = 0; i < source.size(); i += 2)
+  {
+    source[i] = makePayload<T>(static_cast<unsigned char>(i));
+  }
+  std::vector<OptionalType> destination(source.size());
+  AllocationReporter allocations(state);
+  for (auto _ : state)
+  {
+    std::copy(source.begin(), source.end(), destination.begin());
+    benchmark::DoNotOptimize(destination.data());
+  }
+  allocations.report();
+  state.SetItemsProcessed(state.iterations() * source.size());
+}
+
+/// @brief Register a benchmark for voc::Optional and std::optional, with payloads of 8 to 256 bytes
+#define VOC_BENCHMARK_OPTIONAL_PAYLOADS(func)                                \
+  BENCHMARK_TEMPLATE(func, voc::Optional<Payload<8>>, Payload<8>);           \
+  BENCHMARK_TEMPLATE(func, std::optional<Payload<8>>, Payload<8>);           \
+  BENCHMARK_TEMPLATE(func, voc::Optional<Payload<64>>, Payload<64>);         \
+  BENCHMARK_TEMPLATE(func, std::optional<Payload<64>>, Payload<64>);         \
+  BENCHMARK_TEMPLATE(func, voc::Optional<Payload<256>>, Payload<256>);       \
+  BENCHMARK_TEMPLATE(func, std::optional<Payload<256>>, Payload<256>)
+
+VOC_BENCHMARK_OPTIONAL_PAYLOADS(BM_Optional_GetValueOr);
+VOC_BENCHMARK_OPTIONAL_PAYLOADS(BM_Optional_Copy);
+
+/****************************
+ * CONCURRENT BENCHMARKS    *
+ ****************************/
+
+// The thread 0 stores values while the other threads load them. With its flag, Payload<4>
+// fits in an 8 bytes atomic, Payload<8> in a 16 bytes word updated by compare and swap, and
+// Payload<16> uses the sequence lock of AtomicOptional.
+
+namespace
+{
+  /// @brief Optional protected by a mutex, the baseline of AtomicOptional
+  template <typename T>
+  class MutexOptional
+  {
+  public:
+    /// @brief Store a value
+    /// @param value The value
+    void store(const voc::Optional<T> &value)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stored = value;
+    }
+
+    /// @brief Load the value
+    /// @return A copy of the value
+    voc::Optional<T> load() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return stored;
+    }
+
+  private:
+    mutable std::mutex mutex; ///< Protects the value
+    voc::Optional<T> stored;  ///< The value
+  };
+}
+
+template <typename Slot, typename T>
+static void BM_Concurrent_StoreLoad(benchmark::State &state)
+{
+  static Slot slot;
+  if (state.thread_index() == 0)
+  {
+    unsigned char seed = 0;
+    for (auto _ : state)
+    {
+      slot.store(makePayload<T>(++seed));
+    }
+  }
+  else
+  {
+    unsigned sum = 0;
+    for (auto _ : state)
+    {
+      voc::Optional<T> value = slot.load();
+      sum += value.hasValue() ? value->bytes[0] : 0;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, voc::AtomicOptional<Payload<4>>, Payload<4>)->Threads(1)->Threads(2)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, MutexOptional<Payload<4>>, Payload<4>)->Threads(1)->Threads(2)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, voc::AtomicOptional<Payload<8>>, Payload<8>)->Threads(1)->Threads(2)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, MutexOptional<Payload<8>>, Payload<8>)->Threads(1)->Threads(2)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, voc::AtomicOptional<Payload<16>>, Payload<16>)->Threads(1)->Threads(2)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Concurrent_StoreLoad, MutexOptional<Payload<16>>, Payload<16>)->Threads(1)->Threads(2)->Threads(4);
+
+// Readers of an AtomicAny object only write to the counter of their stripe, while the
+// reference count of load() and a reader-writer lock are written by every reader.
+
+namespace
+{
+  /// @brief Any protected by a reader-writer lock, the baseline of AtomicAny
+  class SharedMutexAny
+  {
+  public:
+    /// @brief Constructor
+    /// @param value The initial value
+    explicit SharedMutexAny(voc::Any value) : value(std::move(value)) {}
+
+    /// @brief Call a function with the value, under the read lock
+    /// @param f The function
+    /// @return The result of f
+    template <typename F>
+    auto read(F &&f) const
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      return f(value);
+    }
+
+  private:
+    mutable std::shared_mutex mutex; ///< Protects the value
+    voc::Any value;                  ///< The value
+  };
+
+  /// @brief Configuration read by the AtomicAny benchmarks
+  struct BenchSettings
+  {
+    int timeout;
+    int retries;
+    std::string name;
+  };
+}
+
+static void BM_AtomicAny_Read(benchmark::State &state)
+{
+  static voc::AtomicAny slot(voc::Any(BenchSettings{30, 3, "service"}));
+  int sum = 0;
+  for (auto _ : state)
+  {
+    voc::AtomicAny::Snapshot snapshot = slot.read();
+    sum += voc::anyCast<BenchSettings>(&*snapshot)->timeout;
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AtomicAny_Read)->ThreadRange(1, 8);
+
+static void BM_AtomicAny_Load(benchmark::State &state)
+{
+  static voc::AtomicAny slot(voc::Any(BenchSettings{30, 3, "service"}));
+  int sum = 0;
+  for (auto _ : state)
+  {
+    const voc::SharedAny value = slot.load();
+    sum += voc::anyCast<BenchSettings>(&value)->timeout;
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AtomicAny_Load)->ThreadRange(1, 8);
+
+static void BM_SharedMutexAny_Read(benchmark::State &state)
+{
+  static SharedMutexAny slot(voc::Any(BenchSettings{30, 3, "service"}));
+  int sum = 0;
+  for (auto _ : state)
+  {
+    sum += slot.read([](const voc::Any &value) { return voc::anyCast<BenchSettings>(&value)->timeout; });
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SharedMutexAny_Read)->ThreadRange(1, 8);
+
+static void BM_AtomicAny_Store(benchmark::State &state)
+{
+  voc::AtomicAny slot;
+  int version = 0;
+  for (auto _ : state)
+  {
+    slot.store(voc::Any(BenchSettings{++version, 3, "service"}));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AtomicAny_Store);
+
+// Even threads produce and odd threads consume, each moving the same number of messages.
+// Payload<16> is stored inline by voc::Any, Payload<64> on the heap. The baseline is a
+// std::deque of voc::Any objects guarded by a mutex.
+
+namespace
+{
+  /// @brief Queue of voc::Any objects guarded by a mutex, the baseline of AnyQueue
+  class MutexDequeQueue
+  {
+  public:
+    /// @brief Push a message
+    /// @param value The message
+    void push(voc::Any &&value)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(std::move(value));
+      }
+      notEmpty.notify_one();
+    }
+
+    /// @brief Pop a message, waiting for one if the queue is empty
+    /// @return The message
+    voc::Any pop()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      notEmpty.wait(lock, [this] { return !messages.empty(); });
+      voc::Any value = std::move(messages.front());
+      messages.pop_front();
+      return value;
+    }
+
+  private:
+    std::mutex mutex;                 ///< Protects the messages
+    std::condition_variable notEmpty; ///< Signaled when a message is pushed
+    std::deque<voc::Any> messages;    ///< The messages
+  };
+
+  /// @brief Get the queue shared by the threads of a benchmark
+  template <typename Queue>
+  Queue &benchQueue()
+  {
+    if constexpr (std::is_same<Queue, voc::AnyQueue>::value)
+    {
+      static voc::AnyQueue queue(1024);
+      return queue;
+    }
+    else
+    {
+      static Queue queue;
+      return queue;
+    }
+  }
+}
+
+template <typename Queue, typename T>
+static void BM_Queue_PushPop(benchmark::State &state)
+{
+  Queue &queue = benchQueue<Queue>();
+  unsigned sum = 0;
+  for (auto _ : state)
+  {
+    if (state.thread_index() % 2 == 0)
+    {
+      queue.push(makePayload<T>(static_cast<unsigned char>(sum++)));
+    }
+    else
+    {
+      sum += voc::anyCast<const T &>(queue.pop()).bytes[0];
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, voc::AnyQueue, Payload<16>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, MutexDequeQueue, Payload<16>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, voc::AnyQueue, Payload<64>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_PushPop, MutexDequeQueue, Payload<64>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+template <typename T>
+static void BM_AnyQueue_PushPopBatch(benchmark::State &state)
+{
+  constexpr std::size_t Batch = 16;
+  voc::AnyQueue &queue = benchQueue<voc::AnyQueue>();
+  voc::UniqueAny messages[Batch];
+  unsigned sum = 0;
+  for (auto _ : state)
+  {
+    if (state.thread_index() % 2 == 0)
+    {
+      for (voc::UniqueAny &message : messages)
+      {
+        message = voc::UniqueAny(makePayload<T>(static_cast<unsigned char>(sum++)));
+      }
+      queue.pushN(messages, Batch);
+    }
+    else
+    {
+      for (std::size_t received = 0; received < Batch;)
+      {
+        std::size_t count = queue.popN(messages, Batch - received);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          sum += voc::anyCast<const T &>(messages[i]).bytes[0];
+        }
+        received += count;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * Batch);
+}
+BENCHMARK_TEMPLATE(BM_AnyQueue_PushPopBatch, Payload<16>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AnyQueue_PushPopBatch, Payload<64>)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
@@ -4,6 +4,29 @@
 #ifndef VOC_OPTIONAL_TEST
 #define VOC_OPTIONAL_TEST 1 // for testing the Optional class
 #endif
+#ifndef VOC_ANY_VECTOR_TEST
+#define VOC_ANY_VECTOR_TEST 1 // for testing the AnyVector class
+#endif
+#ifndef VOC_ANY_COLUMNS_TEST
+#define VOC_ANY_COLUMNS_TEST 1 // for testing the AnyColumns class
+#endif
+#ifndef VOC_SHARED_ANY_TEST
+#define VOC_SHARED_ANY_TEST 1 // for testing the SharedAny class
+#endif
+#ifndef VOC_VARIANT_TEST
+#define VOC_VARIANT_TEST 1 // for testing the Variant class
+#endif
+#ifndef VOC_ATOMIC_OPTIONAL_TEST
+#define VOC_ATOMIC_OPTIONAL_TEST 1 // for testing the AtomicOptional class
+#endif
+
+#ifndef VOC_ATOMIC_ANY_TEST
+#define VOC_ATOMIC_ANY_TEST 1 // for testing the AtomicAny class
+#endif
+
+#ifndef VOC_ANY_QUEUE_TEST
+#define VOC_ANY_QUEUE_TEST 1 // for testing the AnyQueue class
+#endif
 
 #ifndef DEBUG
 #define DEBUG 1 // for testing function that does not get tested in the main test
@@ -11,8 +34,139 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <thread>
+
 #include "Any.h"
+#include "AnyColumns.h"
+#include "AnyQueue.h"
+#include "AnyStats.h"
+#include "AnyVector.h"
+#include "AnyVisit.h"
+#include "AtomicAny.h"
+#include "AtomicOptional.h"
+#include "CompactOptional.h"
 #include "Optional.h"
+#include "OptionalArray.h"
+#include "OptionalReductions.h"
+#include "SharedAny.h"
+#include "Variant.h"
+
+/****************************
+ * ALLOCATION COUNTER       *
+ ****************************/
+
+namespace
+{
+  std::atomic<std::size_t> allocationCount{0}; ///< Number of calls to the global operator new
+
+  /// @brief Count the global allocations done by a callable
+  /// @tparam F The type of the callable
+  /// @param f The callable
+  /// @return The number of calls to the global operator new done by f
+  template <typename F>
+  std::size_t countAllocations(F &&f)
+  {
+#if VOC_ENABLE_STATS
+    voc::Any(0).clear(); // register the stats shard of the thread, it allocates once
+#endif
+    std::size_t before = allocationCount.load();
+    f();
+    return allocationCount.load() - before;
+  }
+}
+
+namespace
+{
+  /// @brief Type counting its copies and moves
+  struct Tracked
+  {
+    static inline int copies = 0; ///< Number of copy constructions
+    static inline int moves = 0;  ///< Number of move constructions
+
+    Tracked(int x, int y) : x(x), y(y) {}
+    Tracked(const Tracked &other) : x(other.x), y(other.y) { ++copies; }
+    Tracked(Tracked &&other) noexcept : x(other.x), y(other.y) { ++moves; }
+
+    /// @brief Reset the counters
+    static void reset()
+    {
+      copies = 0;
+      moves = 0;
+    }
+
+    int x;
+    int y;
+  };
+
+  /// @brief Type that can be copied but not moved
+  struct NonMovable
+  {
+    explicit NonMovable(int value) : value(value) {}
+    NonMovable(const NonMovable &) = default;
+    NonMovable(NonMovable &&) = delete;
+
+    int value;
+  };
+
+  /// @brief Visitor made of several lambdas
+  template <typename... Fs>
+  struct Overloaded : Fs...
+  {
+    using Fs::operator()...;
+  };
+
+  template <typename... Fs>
+  Overloaded(Fs...) -> Overloaded<Fs...>;
+
+  /// @brief Event of a large schema
+  template <int N>
+  struct Event
+  {
+    int value;
+  };
+}
+
+// The replacements are inlined when optimizing, GCC then sees new paired with free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size)
+{
+  ++allocationCount;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 #if VOC_ANY_TEST
 /****************************
@@ -64,6 +218,7 @@ TEST(AnyTest, Clear)
   EXPECT_FALSE(any.hasValue());
 }
 
+#if VOC_HAS_RTTI
 TEST(AnyTest, GetType)
 {
   voc::Any any(42);
@@ -71,6 +226,7 @@ TEST(AnyTest, GetType)
   any = 42.0;
   EXPECT_EQ(any.getType(), typeid(double));
 }
+#endif // VOC_HAS_RTTI
 
 TEST(AnyTest, CaseOfUsage)
 {
@@ -134,6 +290,7 @@ TEST(AnyTest, CaseOfUsage)
   }
 }
 
+#if VOC_HAS_RTTI
 TEST(AnyTest, List_Of_Any_But_Different_Type)
 {
 
@@ -171,11 +328,11 @@ TEST(AnyTest, List_Of_Any_But_Different_Type)
     }
     else if (any.getType() == typeid(std::string))
     {
-      std::cout << "\tstring: " << voc::anyCast<std::string>(any) << std::endl;
+      std::cout << "\tstring: " << voc::anyCast<const std::string &>(any) << std::endl;
     }
     else if (any.getType() == typeid(Point))
     {
-      auto point = voc::anyCast<Point>(any);
+      const auto &point = voc::anyCast<const Point &>(any);
       std::cout << "\tPoint: " << point.x << "x" << point.y << std::endl;
     }
   }
@@ -190,6 +347,7 @@ TEST(AnyTest, List_Of_Any_But_Different_Type)
   EXPECT_TRUE(voc::anyCast<std::string>(any_list[2]) == "The cake is a lie!");
   EXPECT_TRUE(voc::anyCast<Point>(any_list[3]) == Point(42, 24));
 }
+#endif // VOC_HAS_RTTI
 
 /*
 Any Lvalue test suite
@@ -265,9 +423,14 @@ TEST(AnyCastTest, AnyCastPointer)
 {
   int original = 42;
   voc::Any any(&original);
-  int *value = voc::anyCast<int *>(&any);
+  int **value = voc::anyCast<int *>(&any);
   ASSERT_NE(value, nullptr);
-  EXPECT_EQ(*value, 42);
+  EXPECT_EQ(**value, 42);
+  voc::Any any_int(42);
+  int *value_int = voc::anyCast<int>(&any_int);
+  ASSERT_NE(value_int, nullptr);
+  EXPECT_EQ(*value_int, 42);
+  EXPECT_EQ(value_int, any_int.contentPtr());
 }
 
 /*
@@ -319,8 +482,8 @@ TEST(AnyMutantTest, MutantTest_AnyCastPointerType)
 {
   int original = 42;
   voc::Any a(&original);
-  int *value = voc::anyCast<int *>(&a);
-  EXPECT_NE(*value, 43); // mutant: change 42 to 43 in anyCast
+  int **value = voc::anyCast<int *>(&a);
+  EXPECT_NE(**value, 43); // mutant: change 42 to 43 in anyCast
 }
 
 TEST(AnyMutantTest, MutantTest_AnyCastConstType)
@@ -337,11 +500,13 @@ TEST(AnyMutantTest, MutantTest_HasValue)
   EXPECT_FALSE(a.hasValue()); // mutant: change clear to not clear the value
 }
 
+#if VOC_HAS_RTTI
 TEST(AnyMutantTest, MutantTest_GetType)
 {
   voc::Any a(42);
   EXPECT_NE(a.getType(), typeid(double)); // mutant: change int to double in getType
 }
+#endif // VOC_HAS_RTTI
 
 TEST(AnyMutantTest, MutantTest_MakeAny)
 {
@@ -349,283 +514,2888 @@ TEST(AnyMutantTest, MutantTest_MakeAny)
   EXPECT_NE(voc::anyCast<int>(a), 43); // mutant: change 42 to 43 in makeAny
 }
 
-#endif // VOC_ANY_TEST
-
-#if VOC_OPTIONAL_TEST
-/****************************
- * TESTS FOR OPTIONAL CLASS *
- ****************************/
-
 /*
-Optional constructor suite
+Any small buffer test suite
 */
-TEST(OptionalConstructorTest, DefaultConstructor)
+TEST(AnySmallBufferTest, SmallTypesAreInline)
 {
-  voc::Optional<int> opt;
-  EXPECT_FALSE(opt.hasValue());
+  struct Point
+  {
+    int x;
+    int y;
+  };
+
+  EXPECT_TRUE(voc::details::AnyFitsInline<int>);
+  EXPECT_TRUE(voc::details::AnyFitsInline<double>);
+  EXPECT_TRUE(voc::details::AnyFitsInline<int *>);
+  EXPECT_TRUE(voc::details::AnyFitsInline<Point>);
 }
 
-TEST(OptionalConstructorTest, ValueConstructor)
+TEST(AnySmallBufferTest, LargeTypesAreOnTheHeap)
 {
-  voc::Optional<int> opt(42);
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  struct Large
+  {
+    char data[64];
+  };
+
+  struct ThrowingMove
+  {
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove &) {}
+    ThrowingMove(ThrowingMove &&) noexcept(false) {}
+  };
+
+  EXPECT_FALSE(voc::details::AnyFitsInline<Large>);
+  EXPECT_FALSE(voc::details::AnyFitsInline<ThrowingMove>);
+  EXPECT_EQ(countAllocations([] { voc::Any any(Large{}); }), 1u);
+  EXPECT_EQ(countAllocations([] { voc::Any any(ThrowingMove{}); }), 1u);
 }
 
-TEST(OptionalConstructorTest, CopyConstructor)
+TEST(AnySmallBufferTest, NoAllocationForSmallTypes)
 {
-  voc::Optional<int> opt1(42);
-  voc::Optional<int> opt2(opt1);
-  EXPECT_TRUE(opt2.hasValue());
-  EXPECT_EQ(opt2.getValue(), 42);
+  EXPECT_EQ(countAllocations([] { voc::Any any(42); }), 0u);
+  EXPECT_EQ(countAllocations([] { voc::Any any(3.14); }), 0u);
+  EXPECT_EQ(countAllocations([] { voc::Any any = voc::makeAny<int>(42); }), 0u);
+  EXPECT_EQ(countAllocations([] {
+              voc::Any a(42);
+              voc::Any b(a);
+              voc::Any c(std::move(a));
+              b = c;
+              c = std::move(b);
+              c = 3.14;
+              EXPECT_EQ(voc::anyCast<double>(c), 3.14);
+            }),
+            0u);
 }
 
-TEST(OptionalConstructorTest, MoveConstructor)
+TEST(AnySmallBufferTest, CopyAndMoveLargeTypes)
 {
-  voc::Optional<int> opt1(42);
-  voc::Optional<int> opt2(std::move(opt1));
-  EXPECT_TRUE(opt2.hasValue());
-  EXPECT_EQ(opt2.getValue(), 42);
+  std::string text(100, 'x');
+  voc::Any a(text);
+  voc::Any b(a);
+  EXPECT_EQ(voc::anyCast<std::string>(b), text);
+  voc::Any c(std::move(a));
+  EXPECT_FALSE(a.hasValue());
+  EXPECT_EQ(voc::anyCast<std::string>(c), text);
+  EXPECT_EQ(countAllocations([&] { voc::Any d(std::move(c)); }), 0u); // the heap object is stolen
+  b = 42;
+  EXPECT_EQ(voc::anyCast<int>(b), 42);
+  b = text;
+  EXPECT_EQ(voc::anyCast<std::string>(b), text);
 }
 
-TEST(OptionalConstructorTest, CopyAssignment)
+/*
+Any manager test suite
+*/
+TEST(AnyManagerTest, Size)
 {
-  voc::Optional<int> opt1(42);
-  voc::Optional<int> opt2;
-  opt2 = opt1;
-  EXPECT_TRUE(opt2.hasValue());
-  EXPECT_EQ(opt2.getValue(), 42);
+  EXPECT_EQ(sizeof(voc::Any), 4 * sizeof(void *)); // inline buffer + manager pointer
 }
 
-TEST(OptionalConstructorTest, MoveAssignment)
+TEST(AnyManagerTest, EmptyAny)
 {
-  voc::Optional<int> opt1(42);
-  voc::Optional<int> opt2;
-  opt2 = std::move(opt1);
-  EXPECT_TRUE(opt2.hasValue());
-  EXPECT_EQ(opt2.getValue(), 42);
+  EXPECT_EQ(countAllocations([] {
+              voc::Any any;
+              EXPECT_FALSE(any.hasValue());
+              EXPECT_EQ(any.getTypeId(), voc::typeId<void>());
+              EXPECT_EQ(any.contentPtr(), nullptr);
+            }),
+            0u);
 }
 
-TEST(OptionalTest, BoolConversion)
+TEST(AnyManagerTest, ContentPtr)
 {
-  voc::Optional<int> opt;
-  EXPECT_FALSE(static_cast<bool>(opt)); // false because no value
-  opt = 42;
-  EXPECT_TRUE(static_cast<bool>(opt)); // true because value
+  voc::Any small(42);
+  ASSERT_NE(small.contentPtr(), nullptr);
+  EXPECT_EQ(*static_cast<const int *>(small.contentPtr()), 42);
+  voc::Any large(std::string(100, 'x'));
+  ASSERT_NE(large.contentPtr(), nullptr);
+  EXPECT_EQ(*static_cast<const std::string *>(large.contentPtr()), std::string(100, 'x'));
 }
 
-TEST(OptionalTest, GetValue)
+TEST(AnyManagerTest, TypeAfterMoveAndClear)
 {
-  voc::Optional<int> opt;
-  opt = 42;
-  EXPECT_EQ(opt.getValue(), 42);
-  const voc::Optional<int> opt_const = 42;
-  EXPECT_EQ(opt_const.getValue(), 42);
+  voc::Any a(std::string("The cake is a lie!"));
+  voc::Any b(std::move(a));
+  EXPECT_EQ(a.getTypeId(), voc::typeId<void>());
+  EXPECT_EQ(b.getTypeId(), voc::typeId<std::string>());
+  b.clear();
+  EXPECT_EQ(b.getTypeId(), voc::typeId<void>());
 }
 
-TEST(OptionalTest, GetValueOr)
+/*
+Any type identifier test suite
+*/
+TEST(AnyTypeIdTest, TypeId)
 {
-  voc::Optional<int> opt;
-  EXPECT_EQ(opt.getValueOr(42), 42);
-  opt = 24;
-  EXPECT_EQ(opt.getValueOr(42), 24);
+  EXPECT_EQ(voc::typeId<int>(), voc::typeId<int>());
+  EXPECT_EQ(voc::typeId<int>(), voc::typeId<const int>());
+  EXPECT_NE(voc::typeId<int>(), voc::typeId<unsigned>());
+  EXPECT_NE(voc::typeId<int>(), voc::typeId<int *>());
+  EXPECT_NE(voc::typeId<void>(), voc::typeId<char>());
 }
 
-TEST(OptionalTest, Clear)
+TEST(AnyTypeIdTest, GetTypeId)
 {
-  voc::Optional<int> opt(42);
-  EXPECT_TRUE(opt.hasValue());
-  opt.clear();
-  EXPECT_FALSE(opt.hasValue());
+  voc::Any any(42);
+  EXPECT_EQ(any.getTypeId(), voc::typeId<int>());
+  any = 3.14;
+  EXPECT_EQ(any.getTypeId(), voc::typeId<double>());
+  any.clear();
+  EXPECT_EQ(any.getTypeId(), voc::typeId<void>());
 }
 
-TEST(OptionalTest, ArrowOperator)
+TEST(AnyTypeIdTest, Holds)
 {
-  struct Point
-  {
-    int x;
-    int y;
-  };
-  voc::Optional<Point> opt;
-  opt = Point{42, 24};
-  EXPECT_EQ(opt->x, 42);
-  EXPECT_EQ(opt->y, 24);
+  voc::Any any(42);
+  EXPECT_TRUE(any.holds<int>());
+  EXPECT_TRUE(any.holds<const int &>());
+  EXPECT_FALSE(any.holds<long>());
+  any.clear();
+  EXPECT_FALSE(any.holds<int>());
 }
 
-TEST(OptionalTest, DereferenceOperator)
+TEST(AnyTypeIdTest, CastMiss)
 {
-  struct Point
-  {
-    int x;
-    int y;
-  };
-  voc::Optional<Point> opt;
-  opt = Point{42, 24};
-  EXPECT_EQ((*opt).x, 42);
-  EXPECT_EQ((*opt).y, 24);
+  voc::Any any(42);
+  EXPECT_THROW(voc::anyCast<unsigned>(any), std::bad_cast);
+  EXPECT_EQ(voc::anyCast<unsigned>(static_cast<const voc::Any *>(&any)), nullptr);
+  EXPECT_EQ(voc::anyCast<unsigned>(&any), nullptr);
 }
 
-TEST(OptionalTest, CaseOfUsage)
+/*
+Any reference cast test suite
+*/
+TEST(AnyReferenceCastTest, LvalueReference)
 {
-  struct Point
-  {
-    int x;
-    int y;
-
-    Point(int x, int y) : x(x), y(y) {}
-  };
+  voc::Any any(std::string("The cake"));
+  std::string &ref = voc::anyCast<std::string &>(any);
+  ref += " is a lie!";
+  EXPECT_EQ(voc::anyCast<const std::string &>(any), "The cake is a lie!");
+  EXPECT_EQ(&ref, any.contentPtr());
+}
 
-  voc::Optional<Point> opt;
-  if (opt)
-  {
-    std::cout << "This will not be printed" << std::endl;
-  }
-  else
-  {
-    std::cout << "This will be printed" << std::endl;
-  }
-  // This will be printed
-  EXPECT_FALSE(static_cast<bool>(opt));
-  opt = Point{42, 24};
-  if (opt)
-  {
-    std::cout << "This will be printed" << std::endl;
-  }
-  else
-  {
-    std::cout << "This will not be printed" << std::endl;
-  }
-  // This will be printed
-  EXPECT_TRUE(static_cast<bool>(opt));
-  std::cout << opt->x << "x" << opt->y << std::endl;
-  // 42x24
-  EXPECT_EQ(opt->x, 42);
-  EXPECT_EQ(opt->y, 24);
-  auto opt_cleared = voc::makeOptional<Point>(42, 42);
-  opt_cleared.clear();
-  std::cout << opt_cleared.hasValue() << std::endl;
-  // 0 (no data)
-  EXPECT_FALSE(opt_cleared.hasValue());
-  try
-  {
-    auto point = opt_cleared.getValue();
-    std::cout << point.x << "x" << point.y << std::endl;
-  }
-  catch (const std::exception &e)
-  {
-    std::cout << e.what() << std::endl; // throw std::runtime_error, no initialized
-  }
+TEST(AnyReferenceCastTest, ConstReference)
+{
+  const voc::Any any(std::string(100, 'x'));
+  EXPECT_EQ(countAllocations([&] {
+              const std::string &ref = voc::anyCast<const std::string &>(any);
+              EXPECT_EQ(ref.size(), 100u);
+              EXPECT_EQ(&ref, any.contentPtr());
+            }),
+            0u);
+  EXPECT_THROW(voc::anyCast<const int &>(any), std::bad_cast);
 }
 
-/*
-Optinal Lvalue test suite
-*/
-TEST(OptionalLvalueTest, LvalueTest)
+TEST(AnyReferenceCastTest, MoveOut)
 {
-  int lvalue = 42;
-  voc::Optional<int> opt(lvalue);
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  voc::Any any(std::string(100, 'x'));
+  std::string moved;
+  EXPECT_EQ(countAllocations([&] { moved = voc::anyCast<std::string>(std::move(any)); }), 0u);
+  EXPECT_EQ(moved, std::string(100, 'x'));
+  EXPECT_TRUE(any.hasValue()); // the Any still holds the moved-from string
+  EXPECT_TRUE(voc::anyCast<const std::string &>(any).empty());
 }
 
-TEST(OptionalLvalueTest, LvalueAssignmentTest)
+TEST(AnyReferenceCastTest, RvalueReference)
 {
-  int lvalue = 42;
-  voc::Optional<int> opt;
-  opt = lvalue; // assign lvalue to Optional
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  voc::Any any(std::string("The cake is a lie!"));
+  std::string &&ref = voc::anyCast<std::string &&>(std::move(any));
+  EXPECT_EQ(&ref, any.contentPtr());
+  std::string moved = std::move(ref);
+  EXPECT_EQ(moved, "The cake is a lie!");
+  EXPECT_THROW(voc::anyCast<int &&>(voc::Any(3.14)), std::bad_cast);
 }
 
-TEST(OptionalLvalueTest, LvalueMakeOptionalTest)
+TEST(AnyReferenceCastTest, PointerCast)
 {
-  int lvalue = 42;
-  auto opt = voc::makeOptional<int>(lvalue);
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  voc::Any any(42);
+  const voc::Any &const_any = any;
+  EXPECT_EQ(voc::anyCast<int>(&any), any.contentPtr());
+  EXPECT_EQ(voc::anyCast<int>(&const_any), any.contentPtr());
+  *voc::anyCast<int>(&any) = 24;
+  EXPECT_EQ(voc::anyCast<int>(any), 24);
+  EXPECT_EQ(voc::anyCast<double>(&any), nullptr);
+  EXPECT_EQ(voc::anyCast<int>(static_cast<voc::Any *>(nullptr)), nullptr);
 }
 
 /*
-Optinal Rvalue test suite
+Any tryCast test suite
 */
-TEST(OptionalRvalueTest, RvalueTest)
+TEST(AnyTryCastTest, Reference)
 {
-  voc::Optional<int> opt(42); // 42 is an rvalue
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  voc::Any any = std::string("The cake is a lie!");
+  static_assert(noexcept(voc::tryCast<int>(any)), "tryCast must not throw");
+  voc::Optional<std::string &> text = voc::tryCast<std::string>(any);
+  ASSERT_TRUE(text.hasValue());
+  EXPECT_EQ(&*text, any.contentPtr()); // no copy
+  *text += " Or is it?";
+  EXPECT_EQ(voc::anyCast<const std::string &>(any), "The cake is a lie! Or is it?");
+  EXPECT_FALSE(voc::tryCast<int>(any).hasValue());
+  EXPECT_FALSE(voc::tryCast<int>(voc::Any()).hasValue());
+
+  const voc::Any &const_any = any;
+  voc::Optional<const std::string &> const_text = voc::tryCast<std::string>(const_any);
+  EXPECT_EQ(const_text->size(), 28u);
 }
 
-TEST(OptionalRvalueTest, RvalueAssignmentTest)
+TEST(AnyTryCastTest, MoveOut)
 {
-  voc::Optional<int> opt;
-  opt = 42; // assign rvalue to Optional
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  Tracked::reset();
+  voc::Any any(voc::InPlaceType<Tracked>, 1, 2);
+  voc::Optional<Tracked> tracked = voc::tryCast<Tracked>(std::move(any));
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(tracked->x, 1);
+  EXPECT_FALSE(voc::tryCast<int>(std::move(any)).hasValue());
 }
 
-TEST(OptionalRvalueTest, RvalueMakeOptionalTest)
+TEST(AnyTryCastTest, TypeProbing)
 {
-  auto opt = voc::makeOptional<int>(42); // 42 is an rvalue
-  EXPECT_TRUE(opt.hasValue());
-  EXPECT_EQ(opt.getValue(), 42);
+  std::vector<voc::Any> values = {42, 3.14, std::string("text"), 'c'};
+  int ints = 0;
+  int doubles = 0;
+  int others = 0;
+  for (voc::Any &any : values)
+  {
+    if (voc::Optional<int &> value = voc::tryCast<int>(any))
+    {
+      ints += *value;
+    }
+    else if (voc::Optional<double &> value = voc::tryCast<double>(any))
+    {
+      ++doubles;
+    }
+    else
+    {
+      ++others;
+    }
+  }
+  EXPECT_EQ(ints, 42);
+  EXPECT_EQ(doubles, 1);
+  EXPECT_EQ(others, 2);
 }
 
 /*
-Optinal mutant test suite
+Any emplace test suite
 */
-TEST(OptionalMutantTest, MutantTest_Constructor) {
+TEST(AnyEmplaceTest, InPlaceConstruction)
+{
+  Tracked::reset();
+  voc::Any a(voc::InPlaceType<Tracked>, 42, 24);
+  voc::Any b = voc::makeAny<Tracked>(42, 24);
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(voc::anyCast<const Tracked &>(b).y, 24);
+}
+
+TEST(AnyEmplaceTest, Emplace)
+{
+  voc::Any any(3.14);
+  Tracked::reset();
+  Tracked &tracked = any.emplace<Tracked>(42, 24);
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(&tracked, any.contentPtr());
+  EXPECT_EQ(voc::anyCast<const Tracked &>(any).x, 42);
+  std::string &text = any.emplace<std::string>(100, 'x');
+  EXPECT_EQ(text, std::string(100, 'x'));
+  EXPECT_EQ(voc::anyCast<const std::string &>(any), text);
+}
+
+TEST(AnyEmplaceTest, NonMovable)
+{
+  voc::Any a = voc::makeAny<NonMovable>(42);
+  EXPECT_EQ(voc::anyCast<const NonMovable &>(a).value, 42);
+  voc::Any b(a);
+  voc::Any c(std::move(a));
+  EXPECT_EQ(voc::anyCast<const NonMovable &>(b).value, 42);
+  EXPECT_EQ(voc::anyCast<const NonMovable &>(c).value, 42);
+  c.emplace<NonMovable>(24);
+  EXPECT_EQ(voc::anyCast<const NonMovable &>(c).value, 24);
+}
+
+TEST(AnyEmplaceTest, InPlaceTypeIsDecayed)
+{
+  voc::Any a = voc::makeAny<const int>(1);
+  EXPECT_TRUE(a.holds<int>());
+  EXPECT_EQ(a.getTypeId(), voc::typeId<int>());
+  EXPECT_EQ(voc::anyCast<int>(a), 1);
+  voc::UniqueAny b(voc::InPlaceType<const std::string>, "text");
+  EXPECT_EQ(voc::anyCast<const std::string &>(b), "text");
+  voc::Any c(a); // the copy has the manager of int too
+  EXPECT_EQ(voc::anyCast<int>(c), 1);
+}
+
+/*
+Any visit test suite
+*/
+TEST(AnyVisitTest, Visit)
+{
+  std::vector<voc::Any> any_list;
+  any_list.push_back(42);
+  any_list.push_back(3.14);
+  any_list.push_back(std::string("The cake is a lie!"));
+  std::string result;
+  for (auto &any : any_list)
+  {
+    voc::visit<int, double, std::string>(any, Overloaded{
+                                                  [&](int &value) { result += "int:" + std::to_string(value) + " "; },
+                                                  [&](double &) { result += "double "; },
+                                                  [&](std::string &value) { result += "string:" + value; },
+                                              });
+  }
+  EXPECT_EQ(result, "int:42 double string:The cake is a lie!");
+}
+
+TEST(AnyVisitTest, ByReference)
+{
+  voc::Any any(std::string("The cake"));
+  voc::visit<int, std::string>(any, Overloaded{
+                                        [](int &) {},
+                                        [](std::string &value) { value += " is a lie!"; },
+                                    });
+  EXPECT_EQ(voc::anyCast<const std::string &>(any), "The cake is a lie!");
+  const voc::Any &const_any = any;
+  std::size_t size = voc::visit<std::string>(const_any, [](const auto &value) -> std::size_t {
+    if constexpr (std::is_same<std::decay_t<decltype(value)>, std::string>::value)
+    {
+      return value.size();
+    }
+    else
+    {
+      return 0;
+    }
+  });
+  EXPECT_EQ(size, 18u);
+}
+
+TEST(AnyVisitTest, Fallback)
+{
+  auto visitor = Overloaded{
+      [](int) { return 1; },
+      [](double) { return 2; },
+      [](voc::Any &any) { return any.hasValue() ? 3 : 4; },
+  };
+  voc::Any any(42);
+  EXPECT_EQ((voc::visit<int, double>(any, visitor)), 1);
+  any = 3.14;
+  EXPECT_EQ((voc::visit<int, double>(any, visitor)), 2);
+  any = 'c';
+  EXPECT_EQ((voc::visit<int, double>(any, visitor)), 3);
+  any.clear();
+  EXPECT_EQ((voc::visit<int, double>(any, visitor)), 4);
+  voc::Any other('c');
+  EXPECT_THROW((voc::visit<int, double>(other, Overloaded{[](int &) {}, [](double &) {}})), std::bad_cast);
+}
+
+TEST(AnyVisitTest, ByValueVisitorIsNotAFallback)
+{
+  voc::Any any(std::string("unlisted"));
+  // Any converts to bool, which converts to int, but the visitor must not be called with it
+  EXPECT_THROW((voc::visit<int, std::string>(any, [](int value) { return value; })), std::bad_cast);
+  EXPECT_THROW((voc::visit<int>(any, [](bool value) { return value; })), std::bad_cast);
+  const voc::Any constAny(std::string("unlisted"));
+  EXPECT_THROW((voc::visit<int, double>(constAny, [](double value) { return value; })), std::bad_cast);
+  // A generic visitor still receives the Any object itself
+  EXPECT_EQ((voc::visit<int>(any, [](const auto &value) { return sizeof(value) == sizeof(int) ? 1 : 2; })), 2);
+  voc::Any number(7);
+  EXPECT_EQ((voc::visit<int, std::string>(number, [](int value) { return value; })), 7);
+}
+
+TEST(AnyVisitTest, LargeTypeList)
+{
+  auto visitor = [](auto &event) -> int {
+    if constexpr (std::is_same<std::decay_t<decltype(event)>, voc::Any>::value)
+    {
+      return -1;
+    }
+    else
+    {
+      return event.value;
+    }
+  };
+  auto visitEvent = [&](voc::Any &any) {
+    return voc::visit<Event<0>, Event<1>, Event<2>, Event<3>, Event<4>, Event<5>, Event<6>, Event<7>, Event<8>, Event<9>,
+                      Event<10>, Event<11>, Event<12>, Event<13>, Event<14>, Event<15>, Event<16>, Event<17>, Event<18>, Event<19>>(any, visitor);
+  };
+  for (int i = 0; i < 3; ++i)
+  {
+    voc::Any a(Event<0>{i});
+    voc::Any b(Event<11>{i + 11});
+    voc::Any c(Event<19>{i + 19});
+    voc::Any d(i);
+    EXPECT_EQ(visitEvent(a), i);
+    EXPECT_EQ(visitEvent(b), i + 11);
+    EXPECT_EQ(visitEvent(c), i + 19);
+    EXPECT_EQ(visitEvent(d), -1);
+  }
+}
+
+TEST(AnyVisitTest, MultipleAny)
+{
+  auto visitor = Overloaded{
+      [](int a, int b) { return std::string("int int ") + std::to_string(a + b); },
+      [](int, const std::string &) { return std::string("int string"); },
+      [](const std::string &, int) { return std::string("string int"); },
+      [](const std::string &, const std::string &) { return std::string("string string"); },
+      [](const voc::Any &, const auto &) { return std::string("unknown"); },
+      [](const auto &, const voc::Any &) { return std::string("unknown"); },
+      [](const voc::Any &, const voc::Any &) { return std::string("unknown"); },
+  };
+  voc::Any i(40);
+  voc::Any j(2);
+  const voc::Any s(std::string("The cake is a lie!"));
+  voc::Any d(3.14);
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, i, j)), "int int 42");
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, i, s)), "int string");
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, s, j)), "string int");
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, s, s)), "string string");
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, d, s)), "unknown");
+  EXPECT_EQ((voc::visit<int, std::string>(visitor, d, d)), "unknown");
+}
+
+/*
+Any allocator test suite
+*/
+namespace
+{
+  /// @brief Memory resource counting the allocations forwarded to its upstream resource
+  class CountingResource : public std::pmr::memory_resource
+  {
+  public:
+    explicit CountingResource(std::pmr::memory_resource *upstream) : upstream(upstream) {}
+
+    std::size_t allocations = 0;   ///< Number of allocations
+    std::size_t deallocations = 0; ///< Number of deallocations
+
+  private:
+    std::pmr::memory_resource *upstream; ///< The resource doing the allocations
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+      ++allocations;
+      return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override
+    {
+      ++deallocations;
+      upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+
+  /// @brief Type too large to be stored inline
+  struct Large
+  {
+    int values[16];
+  };
+}
+
+TEST(AnyAllocatorTest, Size)
+{
+  EXPECT_EQ(sizeof(voc::pmr::Any), 5 * sizeof(void *)); // inline buffer + manager pointer + resource
+}
+
+TEST(AnyAllocatorTest, NoGlobalAllocationWithMonotonicResource)
+{
+  alignas(std::max_align_t) unsigned char buffer[4096];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  CountingResource resource(&arena);
+  std::pmr::polymorphic_allocator<std::byte> alloc(&resource);
+
+  EXPECT_EQ(countAllocations([&] {
+              voc::pmr::Any a(std::allocator_arg, alloc, Large{{42}});
+              voc::pmr::Any b(std::allocator_arg, alloc, voc::InPlaceType<Large>, Large{{24}});
+              voc::pmr::Any c(std::allocator_arg, alloc);
+              c = a; // clone in the resource of c
+              b = std::move(a);
+              c.emplace<Large>(Large{{1}});
+              EXPECT_EQ(voc::anyCast<const Large &>(b).values[0], 42);
+              EXPECT_EQ(voc::anyCast<const Large &>(c).values[0], 1);
+            }),
+            0u);
+  EXPECT_EQ(resource.allocations, 4u);
+  EXPECT_EQ(resource.deallocations, 4u);
+}
+
+TEST(AnyAllocatorTest, InlineValuesDoNotUseTheResource)
+{
+  CountingResource resource(std::pmr::new_delete_resource());
+  voc::pmr::Any any(std::allocator_arg, &resource, 42);
+  voc::pmr::Any copy(std::allocator_arg, &resource, any);
+  EXPECT_EQ(voc::anyCast<int>(copy), 42);
+  EXPECT_EQ(resource.allocations, 0u);
+}
+
+TEST(AnyAllocatorTest, VectorPropagatesTheResource)
+{
+  CountingResource resource(std::pmr::new_delete_resource());
+  {
+    std::pmr::vector<voc::pmr::Any> list(&resource);
+    list.emplace_back(Large{{42}});
+    list.emplace_back(3.14);
+    list.emplace_back(Large{{24}});
+    EXPECT_EQ(list[0].getAllocator().resource(), &resource);
+    EXPECT_EQ(voc::anyCast<const Large &>(list[0]).values[0], 42);
+    EXPECT_EQ(voc::anyCast<double>(list[1]), 3.14);
+    EXPECT_EQ(voc::anyCast<const Large &>(list[2]).values[0], 24);
+  }
+  EXPECT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST(AnyAllocatorTest, MoveAcrossResources)
+{
+  CountingResource first(std::pmr::new_delete_resource());
+  CountingResource second(std::pmr::new_delete_resource());
+  {
+    voc::pmr::Any a(std::allocator_arg, &first, Large{{42}});
+    voc::pmr::Any b(std::allocator_arg, &second);
+    b = std::move(a); // the value is moved into the resource of b
+    EXPECT_FALSE(a.hasValue());
+    EXPECT_EQ(voc::anyCast<const Large &>(b).values[0], 42);
+    EXPECT_EQ(second.allocations, 1u);
+  }
+  EXPECT_EQ(first.allocations, first.deallocations);
+  EXPECT_EQ(second.allocations, second.deallocations);
+}
+
+#if VOC_HAS_RTTI
+TEST(AnyTypeIdTest, GetTypeMatchesTypeId)
+{
+  voc::Any any(std::string("The cake is a lie!"));
+  EXPECT_EQ(any.getType(), typeid(std::string));
+  EXPECT_EQ(any.getTypeId(), voc::typeId<std::string>());
+}
+#else
+TEST(AnyTypeIdTest, GetTypeWithoutRtti)
+{
+  voc::Any any(std::string("The cake is a lie!"));
+  EXPECT_EQ(any.getType(), voc::typeId<std::string>());
+}
+#endif // VOC_HAS_RTTI
+
+/*
+Any stats test suite
+*/
+#if VOC_ENABLE_STATS
+namespace
+{
+  /// @brief Value stored on the heap by Any, only used by the stats tests
+  struct StatsPayload
+  {
+    char bytes[64];
+  };
+
+  /// @brief Value stored inline by Any, only used by the stats tests
+  struct StatsSmallPayload
+  {
+    int value;
+  };
+}
+
+TEST(AnyStatsTest, AllocationsAndClones)
+{
+  voc::AnyStats before = voc::stats();
+  voc::Any a = StatsPayload{};
+  voc::Any b(a);
+  voc::Any c(std::move(a));
+  voc::AnyStats after = voc::stats();
+  EXPECT_EQ(after.allocations - before.allocations, 2u);
+  EXPECT_EQ(after.allocatedBytes - before.allocatedBytes, 2 * sizeof(StatsPayload));
+  EXPECT_EQ(after.clones - before.clones, 1u);
+  EXPECT_EQ(after.moves - before.moves, 1u);
+  EXPECT_EQ(after.valuesOf(voc::typeId<StatsPayload>()) - before.valuesOf(voc::typeId<StatsPayload>()), 2u);
+}
+
+TEST(AnyStatsTest, Casts)
+{
+  voc::Any any = StatsSmallPayload{42};
+  voc::AnyStats before = voc::stats();
+  EXPECT_EQ(voc::anyCast<StatsSmallPayload>(any).value, 42);
+  EXPECT_THROW(voc::anyCast<double>(any), std::bad_cast);
+  EXPECT_FALSE(voc::tryCast<int>(any).hasValue());
+  voc::AnyStats after = voc::stats();
+  EXPECT_EQ(after.castHits - before.castHits, 1u);
+  EXPECT_EQ(after.castMisses - before.castMisses, 2u);
+  EXPECT_EQ(after.allocations - before.allocations, 0u);
+}
+
+TEST(AnyStatsTest, Threads)
+{
+  voc::AnyStats before = voc::stats();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i)
+      {
+        voc::Any any = StatsSmallPayload{i};
+        EXPECT_TRUE(any.hasValue());
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  voc::AnyStats after = voc::stats();
+  EXPECT_EQ(after.valuesOf(voc::typeId<StatsSmallPayload>()) - before.valuesOf(voc::typeId<StatsSmallPayload>()), 4000u);
+  ASSERT_FALSE(after.types.empty());
+  for (std::size_t i = 1; i < after.types.size(); ++i)
+  {
+    EXPECT_GE(after.types[i - 1].values, after.types[i].values);
+  }
+#if VOC_HAS_RTTI
+  auto it = std::find_if(after.types.begin(), after.types.end(), [](const voc::AnyTypeStats &entry) { return entry.typeId == voc::typeId<StatsSmallPayload>(); });
+  ASSERT_NE(it, after.types.end());
+  EXPECT_EQ(*it->type, typeid(StatsSmallPayload));
+#endif
+}
+#else
+TEST(AnyStatsTest, DisabledByDefault)
+{
+  voc::Any a = std::string("The cake is a lie!");
+  voc::Any b(a);
+  voc::AnyStats stats = voc::stats();
+  EXPECT_EQ(stats.allocations, 0u);
+  EXPECT_EQ(stats.clones, 0u);
+  EXPECT_TRUE(stats.types.empty());
+}
+#endif // VOC_ENABLE_STATS
+
+/*
+UniqueAny test suite
+*/
+static_assert(!std::is_copy_constructible<voc::UniqueAny>::value, "UniqueAny must not be copyable");
+static_assert(!std::is_copy_assignable<voc::UniqueAny>::value, "UniqueAny must not be copyable");
+static_assert(std::is_nothrow_move_constructible<voc::UniqueAny>::value, "UniqueAny must be nothrow movable");
+static_assert(std::is_nothrow_move_assignable<voc::UniqueAny>::value, "UniqueAny must be nothrow movable");
+static_assert(!std::is_constructible<voc::Any, voc::UniqueAny>::value, "Any must not store a UniqueAny");
+
+TEST(UniqueAnyTest, MoveOnlyValue)
+{
+  voc::UniqueAny any = std::make_unique<int>(42);
+  ASSERT_TRUE(any.holds<std::unique_ptr<int>>());
+  EXPECT_EQ(*voc::anyCast<const std::unique_ptr<int> &>(any), 42);
+  std::unique_ptr<int> ptr = voc::anyCast<std::unique_ptr<int>>(std::move(any));
+  EXPECT_EQ(*ptr, 42);
+  EXPECT_THROW(voc::anyCast<int>(any), std::bad_cast);
+}
+
+TEST(UniqueAnyTest, InlineStorage)
+{
+  voc::UniqueAny any = std::make_unique<int>(42);
+  const int *value = voc::anyCast<std::unique_ptr<int>>(&any)->get();
+  const void *content = any.contentPtr();
+  EXPECT_GE(content, static_cast<const void *>(&any));
+  EXPECT_LT(content, static_cast<const void *>(&any + 1));
+
+  voc::UniqueAny moved(std::move(any));
+  EXPECT_FALSE(any.hasValue());
+  EXPECT_EQ(voc::anyCast<std::unique_ptr<int> &>(moved).get(), value);
+}
+
+TEST(UniqueAnyTest, LargeValueIsNotMovedWithTheAny)
+{
+  struct LargeMoveOnly
+  {
+    std::unique_ptr<int> ptr;
+    int values[16];
+  };
+  voc::UniqueAny any = voc::makeUniqueAny<LargeMoveOnly>(LargeMoveOnly{std::make_unique<int>(42), {}});
+  const void *content = any.contentPtr();
+  voc::UniqueAny other;
+  other = std::move(any);
+  EXPECT_EQ(other.contentPtr(), content); // the heap allocation is transferred
+  EXPECT_EQ(*voc::anyCast<const LargeMoveOnly &>(other).ptr, 42);
+}
+
+TEST(UniqueAnyTest, EmplaceAndTryCast)
+{
+  voc::UniqueAny any;
+  any.emplace<std::unique_ptr<std::string>>(new std::string("The cake is a lie!"));
+  voc::Optional<std::unique_ptr<std::string> &> text = voc::tryCast<std::unique_ptr<std::string>>(any);
+  ASSERT_TRUE(text.hasValue());
+  EXPECT_EQ(**text, "The cake is a lie!");
+  EXPECT_FALSE(voc::tryCast<int>(any).hasValue());
+  voc::Optional<std::unique_ptr<std::string>> moved = voc::tryCast<std::unique_ptr<std::string>>(std::move(any));
+  EXPECT_EQ(**moved, "The cake is a lie!");
+}
+
+TEST(UniqueAnyTest, FromAny)
+{
+  voc::Any any(std::string("The cake is a lie!"));
+  const void *content = any.contentPtr();
+  voc::UniqueAny unique(std::move(any));
+  EXPECT_FALSE(any.hasValue());
+  EXPECT_TRUE(unique.holds<std::string>());
+  EXPECT_EQ(voc::anyCast<const std::string &>(unique), "The cake is a lie!");
+  unique.emplace<std::unique_ptr<int>>(new int(42));
+  EXPECT_NE(unique.contentPtr(), content);
+}
+
+TEST(UniqueAnyTest, Visit)
+{
+  voc::UniqueAny any = std::make_unique<int>(42);
+  auto visitor = Overloaded{
+      [](std::unique_ptr<int> &value) { return *value; },
+      [](std::string &) { return 0; },
+  };
+  EXPECT_EQ((voc::visit<std::unique_ptr<int>, std::string>(any, visitor)), 42);
+  any = std::string("The cake is a lie!");
+  EXPECT_EQ((voc::visit<std::unique_ptr<int>, std::string>(any, visitor)), 0);
+}
+
+#endif // VOC_ANY_TEST
+
+#if VOC_OPTIONAL_TEST
+/****************************
+ * TESTS FOR OPTIONAL CLASS *
+ ****************************/
+
+/*
+Optional constructor suite
+*/
+TEST(OptionalConstructorTest, DefaultConstructor)
+{
+  voc::Optional<int> opt;
+  EXPECT_FALSE(opt.hasValue());
+}
+
+TEST(OptionalConstructorTest, ValueConstructor)
+{
   voc::Optional<int> opt(42);
-  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in constructor
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_CopyConstructor) {
+TEST(OptionalConstructorTest, CopyConstructor)
+{
   voc::Optional<int> opt1(42);
   voc::Optional<int> opt2(opt1);
-  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in copy constructor
+  EXPECT_TRUE(opt2.hasValue());
+  EXPECT_EQ(opt2.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_MoveConstructor) {
+TEST(OptionalConstructorTest, MoveConstructor)
+{
   voc::Optional<int> opt1(42);
   voc::Optional<int> opt2(std::move(opt1));
-  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in move constructor
+  EXPECT_TRUE(opt2.hasValue());
+  EXPECT_EQ(opt2.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_CopyAssignment) {
+TEST(OptionalConstructorTest, CopyAssignment)
+{
   voc::Optional<int> opt1(42);
   voc::Optional<int> opt2;
   opt2 = opt1;
-  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in copy assignment
+  EXPECT_TRUE(opt2.hasValue());
+  EXPECT_EQ(opt2.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_MoveAssignment) {
+TEST(OptionalConstructorTest, MoveAssignment)
+{
   voc::Optional<int> opt1(42);
   voc::Optional<int> opt2;
   opt2 = std::move(opt1);
-  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in move assignment
+  EXPECT_TRUE(opt2.hasValue());
+  EXPECT_EQ(opt2.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_GetValue) {
-  voc::Optional<int> opt(42);
-  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in getValue
+TEST(OptionalTest, BoolConversion)
+{
+  voc::Optional<int> opt;
+  EXPECT_FALSE(static_cast<bool>(opt)); // false because no value
+  opt = 42;
+  EXPECT_TRUE(static_cast<bool>(opt)); // true because value
 }
 
-TEST(OptionalMutantTest, MutantTest_GetValueOr) {
+TEST(OptionalTest, GetValue)
+{
   voc::Optional<int> opt;
-  EXPECT_NE(opt.getValueOr(42), 43); // mutant: change 42 to 43 in getValueOr
+  opt = 42;
+  EXPECT_EQ(opt.getValue(), 42);
+  const voc::Optional<int> opt_const = 42;
+  EXPECT_EQ(opt_const.getValue(), 42);
 }
 
-TEST(OptionalMutantTest, MutantTest_Clear) {
+TEST(OptionalTest, GetValueOr)
+{
+  voc::Optional<int> opt;
+  EXPECT_EQ(opt.getValueOr(42), 42);
+  opt = 24;
+  EXPECT_EQ(opt.getValueOr(42), 24);
+}
+
+TEST(OptionalTest, Clear)
+{
   voc::Optional<int> opt(42);
+  EXPECT_TRUE(opt.hasValue());
   opt.clear();
-  EXPECT_FALSE(opt.hasValue()); // mutant: change clear to not clear the value
+  EXPECT_FALSE(opt.hasValue());
 }
 
-TEST(OptionalMutantTest, MutantTest_MakeOptional) {
-  auto opt = voc::makeOptional<int>(42);
-  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in makeOptional
+TEST(OptionalTest, ArrowOperator)
+{
+  struct Point
+  {
+    int x;
+    int y;
+  };
+  voc::Optional<Point> opt;
+  opt = Point{42, 24};
+  EXPECT_EQ(opt->x, 42);
+  EXPECT_EQ(opt->y, 24);
 }
 
-#endif // VOC_OPTIONAL_TEST
+TEST(OptionalTest, DereferenceOperator)
+{
+  struct Point
+  {
+    int x;
+    int y;
+  };
+  voc::Optional<Point> opt;
+  opt = Point{42, 24};
+  EXPECT_EQ((*opt).x, 42);
+  EXPECT_EQ((*opt).y, 24);
+}
+
+TEST(OptionalTest, CaseOfUsage)
+{
+  struct Point
+  {
+    int x;
+    int y;
+
+    Point(int x, int y) : x(x), y(y) {}
+  };
+
+  voc::Optional<Point> opt;
+  if (opt)
+  {
+    std::cout << "This will not be printed" << std::endl;
+  }
+  else
+  {
+    std::cout << "This will be printed" << std::endl;
+  }
+  // This will be printed
+  EXPECT_FALSE(static_cast<bool>(opt));
+  opt = Point{42, 24};
+  if (opt)
+  {
+    std::cout << "This will be printed" << std::endl;
+  }
+  else
+  {
+    std::cout << "This will not be printed" << std::endl;
+  }
+  // This will be printed
+  EXPECT_TRUE(static_cast<bool>(opt));
+  std::cout << opt->x << "x" << opt->y << std::endl;
+  // 42x24
+  EXPECT_EQ(opt->x, 42);
+  EXPECT_EQ(opt->y, 24);
+  auto opt_cleared = voc::makeOptional<Point>(42, 42);
+  opt_cleared.clear();
+  std::cout << opt_cleared.hasValue() << std::endl;
+  // 0 (no data)
+  EXPECT_FALSE(opt_cleared.hasValue());
+  try
+  {
+    auto point = opt_cleared.getValue();
+    std::cout << point.x << "x" << point.y << std::endl;
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << e.what() << std::endl; // throw std::runtime_error, no initialized
+  }
+}
+
+/*
+Optional emplace test suite
+*/
+TEST(OptionalEmplaceTest, InPlaceConstruction)
+{
+  Tracked::reset();
+  voc::Optional<Tracked> a(voc::InPlace, 42, 24);
+  auto b = voc::makeOptional<Tracked>(42, 24);
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(b->y, 24);
+}
+
+TEST(OptionalEmplaceTest, Emplace)
+{
+  voc::Optional<Tracked> opt;
+  Tracked::reset();
+  Tracked &first = opt.emplace(42, 24);
+  EXPECT_EQ(&first, &*opt);
+  Tracked &second = opt.emplace(1, 2);
+  EXPECT_EQ(&second, &first); // the storage is reused
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(opt->x, 1);
+  EXPECT_EQ(opt->y, 2);
+}
+
+TEST(OptionalEmplaceTest, NonMovable)
+{
+  auto opt = voc::makeOptional<NonMovable>(42);
+  EXPECT_EQ(opt->value, 42);
+  opt.emplace(24);
+  EXPECT_EQ(opt->value, 24);
+}
+
+TEST(OptionalEmplaceTest, ConstValue)
+{
+  static_assert(std::is_same<decltype(*std::declval<voc::Optional<const int> &>()), const int &>::value);
+  static_assert(std::is_trivially_copyable<voc::Optional<const int>>::value);
+  voc::Optional<const int> a(42);
+  voc::Optional<const int> b;
+  b = a;
+  EXPECT_EQ(*b, 42);
+  b = voc::Optional<const int>(24);
+  EXPECT_EQ(*b, 24);
+  EXPECT_EQ(b.emplace(7), 7);
+
+  voc::Optional<const std::string> s(std::string(32, 'a'));
+  voc::Optional<const std::string> t;
+  t = s;
+  EXPECT_EQ(*t, std::string(32, 'a'));
+  t = voc::Optional<const std::string>(std::string("moved"));
+  EXPECT_EQ(*t, "moved");
+  EXPECT_EQ(t.emplace(3, 'b'), "bbb");
+  EXPECT_EQ(t.transform([](const std::string &value) { return value.size(); }).getValue(), 3u);
+  t.clear();
+  EXPECT_FALSE(t.hasValue());
+}
+
+/*
+Optinal Lvalue test suite
+*/
+TEST(OptionalLvalueTest, LvalueTest)
+{
+  int lvalue = 42;
+  voc::Optional<int> opt(lvalue);
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+TEST(OptionalLvalueTest, LvalueAssignmentTest)
+{
+  int lvalue = 42;
+  voc::Optional<int> opt;
+  opt = lvalue; // assign lvalue to Optional
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+TEST(OptionalLvalueTest, LvalueMakeOptionalTest)
+{
+  int lvalue = 42;
+  auto opt = voc::makeOptional<int>(lvalue);
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+/*
+Optinal Rvalue test suite
+*/
+TEST(OptionalRvalueTest, RvalueTest)
+{
+  voc::Optional<int> opt(42); // 42 is an rvalue
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+TEST(OptionalRvalueTest, RvalueAssignmentTest)
+{
+  voc::Optional<int> opt;
+  opt = 42; // assign rvalue to Optional
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+TEST(OptionalRvalueTest, RvalueMakeOptionalTest)
+{
+  auto opt = voc::makeOptional<int>(42); // 42 is an rvalue
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 42);
+}
+
+/*
+Optinal mutant test suite
+*/
+TEST(OptionalMutantTest, MutantTest_Constructor) {
+  voc::Optional<int> opt(42);
+  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in constructor
+}
+
+TEST(OptionalMutantTest, MutantTest_CopyConstructor) {
+  voc::Optional<int> opt1(42);
+  voc::Optional<int> opt2(opt1);
+  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in copy constructor
+}
+
+TEST(OptionalMutantTest, MutantTest_MoveConstructor) {
+  voc::Optional<int> opt1(42);
+  voc::Optional<int> opt2(std::move(opt1));
+  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in move constructor
+}
+
+TEST(OptionalMutantTest, MutantTest_CopyAssignment) {
+  voc::Optional<int> opt1(42);
+  voc::Optional<int> opt2;
+  opt2 = opt1;
+  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in copy assignment
+}
+
+TEST(OptionalMutantTest, MutantTest_MoveAssignment) {
+  voc::Optional<int> opt1(42);
+  voc::Optional<int> opt2;
+  opt2 = std::move(opt1);
+  EXPECT_NE(opt2.getValue(), 43); // mutant: change 42 to 43 in move assignment
+}
+
+TEST(OptionalMutantTest, MutantTest_GetValue) {
+  voc::Optional<int> opt(42);
+  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in getValue
+}
+
+TEST(OptionalMutantTest, MutantTest_GetValueOr) {
+  voc::Optional<int> opt;
+  EXPECT_NE(opt.getValueOr(42), 43); // mutant: change 42 to 43 in getValueOr
+}
+
+TEST(OptionalMutantTest, MutantTest_Clear) {
+  voc::Optional<int> opt(42);
+  opt.clear();
+  EXPECT_FALSE(opt.hasValue()); // mutant: change clear to not clear the value
+}
+
+TEST(OptionalMutantTest, MutantTest_MakeOptional) {
+  auto opt = voc::makeOptional<int>(42);
+  EXPECT_NE(opt.getValue(), 43); // mutant: change 42 to 43 in makeOptional
+}
+
+TEST(OptionalTrivialityTest, TrivialTypes)
+{
+  static_assert(std::is_trivially_copyable<voc::Optional<int>>::value, "Optional<int> must be trivially copyable");
+  static_assert(std::is_trivially_copyable<voc::Optional<double>>::value, "Optional<double> must be trivially copyable");
+  static_assert(std::is_trivially_copyable<voc::Optional<std::int64_t>>::value, "Optional<int64_t> must be trivially copyable");
+  static_assert(std::is_trivially_copy_constructible<voc::Optional<double>>::value, "Optional<double> must be trivially copy constructible");
+  static_assert(std::is_trivially_move_constructible<voc::Optional<double>>::value, "Optional<double> must be trivially move constructible");
+  static_assert(std::is_trivially_copy_assignable<voc::Optional<double>>::value, "Optional<double> must be trivially copy assignable");
+  static_assert(std::is_trivially_move_assignable<voc::Optional<double>>::value, "Optional<double> must be trivially move assignable");
+  static_assert(std::is_trivially_destructible<voc::Optional<double>>::value, "Optional<double> must be trivially destructible");
+
+  std::vector<voc::Optional<double>> values(4);
+  values[1] = 3.14;
+  values[3] = 42.0;
+  std::vector<voc::Optional<double>> copy(values.size());
+  std::memcpy(copy.data(), values.data(), values.size() * sizeof(voc::Optional<double>));
+  EXPECT_FALSE(copy[0].hasValue());
+  EXPECT_EQ(copy[1].getValue(), 3.14);
+  EXPECT_FALSE(copy[2].hasValue());
+  EXPECT_EQ(copy[3].getValue(), 42.0);
+}
+
+TEST(OptionalTrivialityTest, NonTrivialTypes)
+{
+  static_assert(!std::is_trivially_copyable<voc::Optional<std::string>>::value, "Optional<std::string> cannot be trivially copyable");
+  static_assert(!std::is_trivially_destructible<voc::Optional<std::string>>::value, "Optional<std::string> cannot be trivially destructible");
+  static_assert(std::is_nothrow_move_constructible<voc::Optional<std::string>>::value, "Optional<std::string> must be nothrow move constructible");
+
+  voc::Optional<std::string> opt1(std::string("The cake is a lie!"));
+  voc::Optional<std::string> opt2(opt1);
+  voc::Optional<std::string> opt3(std::move(opt1));
+  EXPECT_FALSE(opt1.hasValue()); // the moved-from object has no value
+  EXPECT_EQ(opt2.getValue(), "The cake is a lie!");
+  EXPECT_EQ(opt3.getValue(), "The cake is a lie!");
+  opt1 = opt2;
+  opt2 = std::move(opt3);
+  EXPECT_FALSE(opt3.hasValue());
+  EXPECT_EQ(opt1.getValue(), "The cake is a lie!");
+  EXPECT_EQ(opt2.getValue(), "The cake is a lie!");
+}
+
+namespace
+{
+  /// @brief Table of optional defaults, built at compile time
+  constexpr voc::Optional<int> defaultsTable[] = {42, {}, voc::makeOptional<int>(24), voc::Optional<int>(voc::InPlace, 7)};
+
+  /// @brief Point usable in constant expressions
+  struct Point
+  {
+    constexpr Point(int x, int y) : x(x), y(y) {}
+
+    int x;
+    int y;
+  };
+}
+
+TEST(OptionalConstexprTest, ConstantExpressions)
+{
+  static_assert(defaultsTable[0].hasValue() && defaultsTable[0].getValue() == 42, "the value is built at compile time");
+  static_assert(!defaultsTable[1].hasValue(), "the empty value is built at compile time");
+  static_assert(*defaultsTable[2] == 24 && defaultsTable[3].getValueOr(0) == 7, "makeOptional is usable at compile time");
+  static_assert(defaultsTable[1].getValueOr(-1) == -1, "getValueOr is usable at compile time");
+
+  constexpr voc::Optional<Point> point = voc::makeOptional<Point>(1, 2);
+  static_assert(point->x == 1 && (*point).y == 2, "the accessors are usable at compile time");
+  constexpr voc::Optional<Point> copy = point;
+  static_assert(static_cast<bool>(copy) && copy->y == 2, "the copy is usable at compile time");
+
+  EXPECT_EQ(defaultsTable[0].getValue(), 42);
+  EXPECT_FALSE(defaultsTable[1].hasValue());
+}
+
+namespace
+{
+  /// @brief Policy of a user type, the empty state is a negative id
+  struct IdPolicy
+  {
+    static constexpr int empty() noexcept { return -1; }
+    static constexpr bool isEmpty(const int &value) noexcept { return value < 0; }
+  };
+}
+
+TEST(CompactOptionalTest, Size)
+{
+  static_assert(sizeof(voc::CompactOptional<double>) == sizeof(double), "no flag for NaN-encoded doubles");
+  static_assert(sizeof(voc::CompactOptional<int *>) == sizeof(int *), "no flag for null-encoded pointers");
+  static_assert(sizeof(voc::CompactOptional<std::int64_t, voc::SentinelPolicy<std::int64_t, INT64_MIN>>) == sizeof(std::int64_t), "no flag for sentinel-encoded integers");
+  static_assert(std::is_trivially_copyable<voc::CompactOptional<double>>::value, "CompactOptional<double> must be trivially copyable");
+}
+
+TEST(CompactOptionalTest, NaN)
+{
+  voc::CompactOptional<double> opt;
+  EXPECT_FALSE(opt.hasValue());
+  EXPECT_THROW(opt.getValue(), std::runtime_error);
+  EXPECT_EQ(opt.getValueOr(1.5), 1.5);
+  opt = 3.14;
+  EXPECT_TRUE(static_cast<bool>(opt));
+  EXPECT_EQ(*opt, 3.14);
+  opt.clear();
+  EXPECT_FALSE(opt.hasValue());
+  opt = std::numeric_limits<double>::quiet_NaN(); // the sentinel means no value
+  EXPECT_FALSE(opt.hasValue());
+}
+
+TEST(CompactOptionalTest, Pointer)
+{
+  int value = 42;
+  voc::CompactOptional<int *> opt;
+  EXPECT_FALSE(opt.hasValue());
+  opt.emplace(&value);
+  EXPECT_EQ(*opt.getValue(), 42);
+}
+
+TEST(CompactOptionalTest, Sentinel)
+{
+  using OptionalId = voc::CompactOptional<std::int64_t, voc::SentinelPolicy<std::int64_t, INT64_MIN>>;
+  OptionalId opt(0);
+  EXPECT_TRUE(opt.hasValue());
+  EXPECT_EQ(opt.getValue(), 0);
+  opt.clear();
+  EXPECT_FALSE(opt.hasValue());
+  EXPECT_EQ(opt.getValueOr(7), 7);
+
+  voc::CompactOptional<int, IdPolicy> id = voc::makeCompactOptional<int, IdPolicy>(3);
+  EXPECT_EQ(id.getValue(), 3);
+  id = -5;
+  EXPECT_FALSE(id.hasValue());
+}
+
+TEST(CompactOptionalTest, ConstantExpressions)
+{
+  constexpr voc::CompactOptional<int, IdPolicy> table[] = {1, {}, voc::makeCompactOptional<int, IdPolicy>(3)};
+  static_assert(table[0].hasValue() && *table[0] == 1, "the value is built at compile time");
+  static_assert(!table[1].hasValue() && table[1].getValueOr(2) == 2, "the empty value is built at compile time");
+  static_assert(table[2].getValue() == 3, "makeCompactOptional is usable at compile time");
+  EXPECT_EQ(table[2].getValue(), 3);
+}
+
+TEST(OptionalArrayTest, Access)
+{
+  voc::OptionalArray<int> array;
+  array.pushBack(42);
+  array.pushNull();
+  array.pushBack(voc::Optional<int>(24));
+  array.pushBack(voc::Optional<int>());
+  EXPECT_EQ(array.size(), 4u);
+  EXPECT_TRUE(array[0].hasValue());
+  EXPECT_EQ(array[0].getValue(), 42);
+  EXPECT_FALSE(static_cast<bool>(array[1]));
+  EXPECT_THROW(array[1].getValue(), std::runtime_error);
+  EXPECT_EQ(array[1].getValueOr(7), 7);
+  EXPECT_EQ(*array[2], 24);
+  EXPECT_FALSE(array.hasValue(3));
+
+  array[1] = 1;
+  array[2].clear();
+  array[3].emplace(3);
+  array[0] = array[2];
+  EXPECT_FALSE(array[0].hasValue());
+  EXPECT_EQ(array[1].getValue(), 1);
+  EXPECT_FALSE(array[2].hasValue());
+  EXPECT_EQ(array[3].getValue(), 3);
+
+  const voc::OptionalArray<int> &const_array = array;
+  voc::Optional<int> value = const_array[3];
+  EXPECT_EQ(value.getValue(), 3);
+  voc::Optional<int> null = const_array[0];
+  EXPECT_FALSE(null.hasValue());
+}
+
+TEST(OptionalArrayTest, CountAndFillNulls)
+{
+  voc::OptionalArray<double> array;
+  for (int i = 0; i < 200; ++i)
+  {
+    if (i % 3 == 0 || (i >= 64 && i < 128))
+    {
+      array.pushBack(i);
+    }
+    else
+    {
+      array.pushNull();
+    }
+  }
+  std::size_t expected = 0;
+  for (int i = 0; i < 200; ++i)
+  {
+    expected += (i % 3 == 0 || (i >= 64 && i < 128)) ? 1 : 0;
+  }
+  EXPECT_EQ(array.countValues(), expected);
+
+  std::vector<double> filled(array.size());
+  array.getValuesOr(-1.0, filled.data());
+  EXPECT_EQ(filled[0], 0.0);
+  EXPECT_EQ(filled[1], -1.0);
+  EXPECT_EQ(filled[65], 65.0);
+  EXPECT_EQ(array.countValues(), expected);
+
+  array.fillNulls(-1.0);
+  EXPECT_EQ(array.countValues(), 200u);
+  EXPECT_EQ(array[0].getValue(), 0.0);
+  EXPECT_EQ(array[1].getValue(), -1.0);
+  EXPECT_EQ(array[65].getValue(), 65.0);
+  EXPECT_EQ(array[199].getValue(), -1.0);
+  EXPECT_EQ(array.bitmap()[3], (std::uint64_t(1) << 8) - 1); // the bits after the last element stay zero
+}
+
+TEST(OptionalArrayTest, AppendAndSlice)
+{
+  voc::OptionalArray<int> first;
+  for (int i = 0; i < 70; ++i)
+  {
+    first.pushBack(i % 2 == 0 ? voc::Optional<int>(i) : voc::Optional<int>());
+  }
+  voc::OptionalArray<int> second;
+  for (int i = 0; i < 100; ++i)
+  {
+    if (i % 5 == 0)
+    {
+      second.pushNull();
+    }
+    else
+    {
+      second.pushBack(i);
+    }
+  }
+  voc::OptionalArray<int> all = first.slice(3, 60);
+  all.append(second);
+  ASSERT_EQ(all.size(), 160u);
+  for (std::size_t i = 0; i < 60; ++i)
+  {
+    EXPECT_EQ(all.hasValue(i), first.hasValue(i + 3));
+    EXPECT_EQ(all[i].getValueOr(-1), first[i + 3].getValueOr(-1));
+  }
+  for (std::size_t i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(all.hasValue(60 + i), second.hasValue(i));
+    EXPECT_EQ(all[60 + i].getValueOr(-1), second[i].getValueOr(-1));
+  }
+  EXPECT_EQ(all.countValues(), first.slice(3, 60).countValues() + second.countValues());
+  EXPECT_EQ(all.slice(160, 0).size(), 0u);
+  EXPECT_THROW(all.slice(100, 61), std::out_of_range);
+}
+
+TEST(OptionalArrayTest, SelfAppend)
+{
+  voc::OptionalArray<std::string> array;
+  for (int i = 0; i < 70; ++i)
+  {
+    if (i % 3 == 0)
+    {
+      array.pushNull();
+    }
+    else
+    {
+      array.pushBack(std::to_string(i));
+    }
+  }
+  array.append(array);
+  ASSERT_EQ(array.size(), 140u);
+  for (std::size_t i = 0; i < 70; ++i)
+  {
+    EXPECT_EQ(array.hasValue(70 + i), array.hasValue(i));
+    EXPECT_EQ(array[70 + i].getValueOr("null"), array[i].getValueOr("null"));
+  }
+  EXPECT_EQ(array.countValues(), 2 * 46u);
+}
+
+namespace
+{
+  /// @brief Create an array of doubles with a pseudo-random validity
+  /// @param count The number of elements
+  /// @param seed The seed of the generator
+  /// @return The array, the values are integers so that the sums are exact
+  voc::OptionalArray<double> makeRandomArray(std::size_t count, unsigned seed)
+  {
+    std::mt19937 generator(seed);
+    voc::OptionalArray<double> array;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      if (generator() % 3 != 0)
+      {
+        array.pushBack(static_cast<double>(static_cast<int>(generator() % 2001) - 1000));
+      }
+      else
+      {
+        array.pushNull();
+      }
+    }
+    return array;
+  }
+
+  /// @brief The levels to test, the ones that are not supported are run as the best supported one
+  const voc::SimdLevel allLevels[] = {voc::SimdLevel::Scalar, voc::SimdLevel::Sse2, voc::SimdLevel::Avx2};
+}
+
+TEST(OptionalReductionsTest, MatchScalar)
+{
+  for (std::size_t count : {0u, 1u, 63u, 64u, 65u, 1000u, 4099u})
+  {
+    voc::OptionalArray<double> array = makeRandomArray(count, static_cast<unsigned>(count));
+    const double *values = array.data();
+    const std::uint64_t *validity = array.bitmap();
+    for (voc::SimdLevel level : allLevels)
+    {
+      EXPECT_EQ(voc::maskedSum(values, validity, count, level), voc::maskedSum<double>(values, validity, count));
+      voc::Optional<double> min = voc::maskedMin(values, validity, count, level);
+      voc::Optional<double> max = voc::maskedMax(values, validity, count, level);
+      voc::Optional<double> expectedMin = voc::maskedMin<double>(values, validity, count);
+      voc::Optional<double> expectedMax = voc::maskedMax<double>(values, validity, count);
+      EXPECT_EQ(min.hasValue(), expectedMin.hasValue());
+      EXPECT_EQ(max.hasValue(), expectedMax.hasValue());
+      EXPECT_EQ(min.getValueOr(0.0), expectedMin.getValueOr(0.0));
+      EXPECT_EQ(max.getValueOr(0.0), expectedMax.getValueOr(0.0));
+
+      std::vector<double> coalesced(count);
+      std::vector<double> expected(count);
+      voc::maskedCoalesce(values, validity, count, 0.5, coalesced.data(), level);
+      voc::maskedCoalesce<double>(values, validity, count, 0.5, expected.data());
+      EXPECT_EQ(coalesced, expected);
+    }
+  }
+}
+
+TEST(OptionalReductionsTest, NullsAreIgnored)
+{
+  std::vector<double> values(130, std::numeric_limits<double>::quiet_NaN()); // the values without validity bit are never read
+  std::vector<std::uint64_t> validity(3, 0);
+  values[5] = 2.0;
+  values[100] = -3.0;
+  values[129] = 7.0;
+  validity[0] = std::uint64_t(1) << 5;
+  validity[1] = std::uint64_t(1) << (100 - 64);
+  validity[2] = std::uint64_t(1) << (129 - 128);
+  for (voc::SimdLevel level : allLevels)
+  {
+    EXPECT_EQ(voc::maskedSum(values.data(), validity.data(), values.size(), level), 6.0);
+    EXPECT_EQ(voc::maskedMin(values.data(), validity.data(), values.size(), level).getValue(), -3.0);
+    EXPECT_EQ(voc::maskedMax(values.data(), validity.data(), values.size(), level).getValue(), 7.0);
+  }
+  EXPECT_EQ(voc::maskedCount(validity.data(), values.size()), 3u);
+  EXPECT_EQ(voc::maskedMean(values.data(), validity.data(), values.size()).getValue(), 2.0);
+
+  std::vector<std::uint64_t> none(3, 0);
+  EXPECT_EQ(voc::maskedSum(values.data(), none.data(), values.size()), 0.0);
+  EXPECT_FALSE(voc::maskedMin(values.data(), none.data(), values.size()).hasValue());
+  EXPECT_FALSE(voc::maskedMax(values.data(), none.data(), values.size()).hasValue());
+  EXPECT_FALSE(voc::maskedMean(values.data(), none.data(), values.size()).hasValue());
+}
+
+TEST(OptionalReductionsTest, OptionalArray)
+{
+  voc::OptionalArray<int> integers;
+  integers.pushBack(3);
+  integers.pushNull();
+  integers.pushBack(-1);
+  integers.pushBack(4);
+  EXPECT_EQ(voc::maskedCount(integers), 3u);
+  EXPECT_EQ(voc::maskedSum(integers), 6);
+  EXPECT_EQ(voc::maskedMin(integers).getValue(), -1);
+  EXPECT_EQ(voc::maskedMax(integers).getValue(), 4);
+  EXPECT_EQ(voc::maskedMean(integers).getValue(), 2.0);
+  std::vector<int> coalesced(integers.size());
+  voc::maskedCoalesce(integers, 0, coalesced.data());
+  EXPECT_EQ(coalesced, (std::vector<int>{3, 0, -1, 4}));
+
+  voc::OptionalArray<double> doubles = makeRandomArray(1000, 42);
+  EXPECT_EQ(voc::maskedSum(doubles), voc::maskedSum<double>(doubles.data(), doubles.bitmap(), doubles.size()));
+  EXPECT_EQ(voc::maskedMean(doubles).getValue(), voc::maskedSum(doubles) / voc::maskedCount(doubles));
+}
+
+TEST(OptionalMonadicTest, GetValueOrElse)
+{
+  int calls = 0;
+  auto makeDefault = [&]() {
+    ++calls;
+    return std::string("default");
+  };
+  voc::Optional<std::string> engaged(std::string("The cake is a lie!"));
+  voc::Optional<std::string> empty;
+  EXPECT_EQ(engaged.getValueOrElse(makeDefault), "The cake is a lie!");
+  EXPECT_EQ(calls, 0); // the default is not built
+  EXPECT_EQ(empty.getValueOrElse(makeDefault), "default");
+  EXPECT_EQ(calls, 1);
+
+  Tracked::reset();
+  voc::Optional<Tracked> tracked(voc::InPlace, 1, 2);
+  Tracked moved = std::move(tracked).getValueOrElse([]() { return Tracked(0, 0); });
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(moved.x, 1);
+}
+
+TEST(OptionalMonadicTest, GetValueOrByReference)
+{
+  voc::Optional<std::string> engaged(std::string("The cake is a lie!"));
+  voc::Optional<std::string> empty;
+  const std::string fallback = "fallback";
+  const std::string &value = engaged.getValueOr(fallback);
+  const std::string &other = empty.getValueOr(fallback);
+  EXPECT_EQ(&value, &*engaged); // no copy
+  EXPECT_EQ(&other, &fallback);
+  static_assert(std::is_same<decltype(engaged.getValueOr(fallback)), const std::string &>::value, "an lvalue default gives a reference");
+  static_assert(std::is_same<decltype(engaged.getValueOr("fallback")), std::string>::value, "a default of another type gives a value");
+
+  Tracked::reset();
+  voc::Optional<Tracked> tracked(voc::InPlace, 1, 2);
+  Tracked moved = std::move(tracked).getValueOr(Tracked(0, 0));
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(moved.y, 2);
+}
+
+TEST(OptionalMonadicTest, Transform)
+{
+  voc::Optional<int> engaged(21);
+  voc::Optional<int> empty;
+  voc::Optional<double> doubled = engaged.transform([](int value) { return value * 2.0; });
+  EXPECT_EQ(doubled.getValue(), 42.0);
+  EXPECT_FALSE(empty.transform([](int value) { return value * 2.0; }).hasValue());
+
+  Tracked::reset();
+  voc::Optional<Tracked> tracked(voc::InPlace, 1, 2);
+  voc::Optional<Tracked> swapped = std::move(tracked).transform([](Tracked &&value) { return Tracked(value.y, value.x); });
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0); // the result is built in place
+  EXPECT_EQ(swapped->x, 2);
+
+  const voc::Optional<std::string> text(std::string("The cake is a lie!"));
+  EXPECT_EQ(text.transform([](const std::string &value) { return value.size(); }).getValue(), 18u);
+}
+
+TEST(OptionalMonadicTest, AndThenAndOrElse)
+{
+  auto parse = [](const std::string &text) {
+    return text.empty() ? voc::Optional<int>() : voc::Optional<int>(static_cast<int>(text.size()));
+  };
+  voc::Optional<std::string> engaged(std::string("abc"));
+  voc::Optional<std::string> blank{std::string()};
+  voc::Optional<std::string> empty;
+  EXPECT_EQ(engaged.andThen(parse).getValue(), 3);
+  EXPECT_FALSE(blank.andThen(parse).hasValue());
+  EXPECT_FALSE(empty.andThen(parse).hasValue());
+
+  int calls = 0;
+  auto fallback = [&]() {
+    ++calls;
+    return voc::Optional<std::string>(std::string("fallback"));
+  };
+  EXPECT_EQ(engaged.orElse(fallback).getValue(), "abc");
+  EXPECT_EQ(calls, 0);
+  EXPECT_EQ(empty.orElse(fallback).getValue(), "fallback");
+  EXPECT_EQ(std::move(engaged).orElse(fallback).getValue(), "abc");
+  EXPECT_EQ(calls, 1);
+}
+
+namespace
+{
+  /// @brief Cache returning references to its values
+  class Cache
+  {
+  public:
+    /// @brief Find a value
+    /// @param key The key of the value
+    /// @return A reference to the value, or no value if the key is not in the cache
+    voc::Optional<std::string &> find(int key)
+    {
+      auto found = values.find(key);
+      return found == values.end() ? voc::Optional<std::string &>() : voc::Optional<std::string &>(found->second);
+    }
+
+    std::map<int, std::string> values; ///< The values
+  };
+}
+
+TEST(OptionalReferenceTest, Layout)
+{
+  static_assert(sizeof(voc::Optional<std::string &>) == sizeof(std::string *), "Optional<T &> must be one pointer wide");
+  static_assert(sizeof(voc::Optional<const int &>) == sizeof(const int *), "Optional<T &> must be one pointer wide");
+  static_assert(std::is_trivially_copyable<voc::Optional<int &>>::value, "Optional<T &> must be trivially copyable");
+  static_assert(!std::is_constructible<voc::Optional<const int &>, int>::value, "Optional<T &> cannot refer to a temporary");
+  static_assert(std::is_convertible<voc::Optional<int &>, voc::Optional<const int &>>::value, "a reference converts to a const reference");
+  static_assert(!std::is_convertible<voc::Optional<const int &>, voc::Optional<int &>>::value, "a const reference does not convert to a reference");
+}
+
+TEST(OptionalReferenceTest, Rebind)
+{
+  int first = 1;
+  int second = 2;
+  voc::Optional<int &> ref;
+  EXPECT_FALSE(ref.hasValue());
+  EXPECT_THROW(ref.getValue(), std::runtime_error);
+  ref = first;
+  *ref = 10;
+  EXPECT_EQ(first, 10);
+  ref = second; // rebinds, first is not modified
+  EXPECT_EQ(first, 10);
+  EXPECT_EQ(&ref.getValue(), &second);
+  voc::Optional<int &> copy = ref;
+  copy.emplace(first);
+  EXPECT_EQ(&*ref, &second);
+  EXPECT_EQ(&*copy, &first);
+  copy.clear();
+  EXPECT_FALSE(static_cast<bool>(copy));
+  EXPECT_EQ(first, 10);
+}
+
+TEST(OptionalReferenceTest, ValueOr)
+{
+  std::string value = "value";
+  std::string fallback = "fallback";
+  voc::Optional<std::string &> engaged(value);
+  voc::Optional<std::string &> empty;
+  EXPECT_EQ(&engaged.getValueOr(fallback), &value);
+  EXPECT_EQ(&empty.getValueOr(fallback), &fallback);
+  EXPECT_EQ(empty.getValueOr("literal"), "literal");
+  EXPECT_EQ(empty.getValueOrElse([]() { return std::string("lazy"); }), "lazy");
+
+  voc::Optional<const std::string &> const_ref = engaged;
+  EXPECT_EQ(const_ref->size(), 5u);
+  EXPECT_EQ(engaged.transform([](std::string &text) { return text.size(); }).getValue(), 5u);
+  EXPECT_FALSE(empty.andThen([](std::string &text) { return voc::Optional<char &>(text[0]); }).hasValue());
+  EXPECT_EQ(&*empty.orElse([&]() { return voc::Optional<std::string &>(fallback); }), &fallback);
+}
+
+TEST(OptionalReferenceTest, Lookup)
+{
+  Cache cache;
+  cache.values[1] = "one";
+  if (voc::Optional<std::string &> found = cache.find(1))
+  {
+    *found += "!";
+  }
+  EXPECT_EQ(cache.values[1], "one!");
+  EXPECT_FALSE(cache.find(2).hasValue());
+}
+
+#endif // VOC_OPTIONAL_TEST
+
+#if VOC_ANY_VECTOR_TEST
+/*****************************
+ * TESTS FOR ANYVECTOR CLASS *
+ *****************************/
+
+TEST(AnyVectorTest, PushBackAndGet)
+{
+  struct Point
+  {
+    int x;
+    int y;
+  };
+
+  voc::AnyVector list;
+  EXPECT_TRUE(list.empty());
+  list.pushBack(42);
+  list.pushBack(3.14);
+  list.pushBack(std::string("The cake is a lie!"));
+  list.pushBack(Point{42, 24});
+  EXPECT_EQ(list.size(), 4u);
+  EXPECT_EQ(list.get<int>(0), 42);
+  EXPECT_EQ(list.get<double>(1), 3.14);
+  EXPECT_EQ(list.get<std::string>(2), "The cake is a lie!");
+  EXPECT_EQ(list.get<Point>(3).y, 24);
+  EXPECT_TRUE(list.holds<double>(1));
+  EXPECT_FALSE(list.holds<int>(1));
+  EXPECT_EQ(list.getTypeId(2), voc::typeId<std::string>());
+  EXPECT_EQ(list.getIf<int>(1), nullptr);
+  EXPECT_THROW(list.get<int>(1), std::bad_cast);
+}
+
+TEST(AnyVectorTest, Alignment)
+{
+  voc::AnyVector list;
+  list.pushBack('a');
+  list.pushBack(3.14);
+  list.pushBack('b');
+  list.pushBack(static_cast<long double>(1.5));
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&list.get<double>(1)) % alignof(double), 0u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&list.get<long double>(3)) % alignof(long double), 0u);
+  EXPECT_EQ(list.get<char>(2), 'b');
+}
+
+TEST(AnyVectorTest, Growth)
+{
+  voc::AnyVector list;
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (i % 2 == 0)
+    {
+      list.pushBack(i);
+    }
+    else
+    {
+      list.pushBack(std::to_string(i));
+    }
+  }
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (i % 2 == 0)
+    {
+      EXPECT_EQ(list.get<int>(i), i);
+    }
+    else
+    {
+      EXPECT_EQ(list.get<std::string>(i), std::to_string(i));
+    }
+  }
+}
+
+TEST(AnyVectorTest, PushBackOwnElement)
+{
+  voc::AnyVector list;
+  list.pushBack(std::string(100, 'x'));
+  for (int i = 0; i < 10; ++i)
+  {
+    list.pushBack(list.get<std::string>(0)); // may reallocate while reading the element
+  }
+  for (std::size_t i = 0; i < list.size(); ++i)
+  {
+    EXPECT_EQ(list.get<std::string>(i), std::string(100, 'x'));
+  }
+}
+
+TEST(AnyVectorTest, ForEach)
+{
+  voc::AnyVector list;
+  for (int i = 0; i < 10; ++i)
+  {
+    list.pushBack(i);
+    list.pushBack(static_cast<double>(i) / 2);
+  }
+  int sum = 0;
+  list.forEach<int>([&](int &value) { sum += value; });
+  EXPECT_EQ(sum, 45);
+  double total = 0;
+  const voc::AnyVector &const_list = list;
+  const_list.forEach<double>([&](const double &value) { total += value; });
+  EXPECT_EQ(total, 22.5);
+}
+
+TEST(AnyVectorTest, EmplaceBack)
+{
+  Tracked::reset();
+  voc::AnyVector list;
+  Tracked &tracked = list.emplaceBack<Tracked>(42, 24);
+  EXPECT_EQ(tracked.x, 42);
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+}
+
+TEST(AnyVectorTest, CvQualifiedTypes)
+{
+  voc::AnyVector list;
+  list.emplaceBack<const int>(7);
+  list.pushBack(5);
+  EXPECT_TRUE(list.holds<int>(0));
+  EXPECT_TRUE(list.holds<const int>(1));
+  ASSERT_NE(list.getIf<int>(0), nullptr);
+  EXPECT_EQ(*list.getIf<int>(0), 7);
+  int sum = 0;
+  list.forEach<const int>([&](const int &value) { sum += value; });
+  EXPECT_EQ(sum, 12);
+  sum = 0;
+  const voc::AnyVector &const_list = list;
+  const_list.forEach<const int>([&](const int &value) { sum += value; });
+  EXPECT_EQ(sum, 12);
+}
+
+TEST(AnyVectorTest, CopyMoveAndDestroy)
+{
+  auto shared = std::make_shared<int>(42);
+  {
+    voc::AnyVector list;
+    list.pushBack(1);
+    list.pushBack(shared);
+    voc::AnyVector copy(list);
+    EXPECT_EQ(shared.use_count(), 3);
+    voc::AnyVector moved(std::move(list));
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(shared.use_count(), 3);
+    list = copy;
+    EXPECT_EQ(shared.use_count(), 4);
+    EXPECT_EQ(*list.get<std::shared_ptr<int>>(1), 42);
+    moved.popBack();
+    EXPECT_EQ(shared.use_count(), 3);
+    EXPECT_EQ(moved.size(), 1u);
+    copy.clear();
+    EXPECT_EQ(shared.use_count(), 2);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(AnyVectorTest, ThrowingMoveTypes)
+{
+  struct ThrowingMove
+  {
+    explicit ThrowingMove(int value) : value(value) {}
+    ThrowingMove(const ThrowingMove &other) : value(other.value) {}
+    ThrowingMove(ThrowingMove &&other) noexcept(false) : value(other.value) {}
+    int value;
+  };
+
+  voc::AnyVector list;
+  for (int i = 0; i < 100; ++i)
+  {
+    list.emplaceBack<ThrowingMove>(i);
+    list.pushBack(std::to_string(i));
+  }
+  EXPECT_EQ(list.get<ThrowingMove>(98).value, 49);
+  EXPECT_EQ(list.get<std::string>(99), "49");
+}
+
+TEST(AnyVectorTest, SingleAllocationWhenReserved)
+{
+  voc::AnyVector list;
+  list.reserve(100, 100 * sizeof(double));
+  EXPECT_EQ(countAllocations([&] {
+              for (int i = 0; i < 100; ++i)
+              {
+                list.pushBack(static_cast<double>(i));
+              }
+            }),
+            0u);
+  EXPECT_EQ(list.bytes(), 100 * sizeof(double));
+}
+
+#endif // VOC_ANY_VECTOR_TEST
+
+#if VOC_ANY_COLUMNS_TEST
+/******************************
+ * TESTS FOR ANYCOLUMNS CLASS *
+ ******************************/
+
+TEST(AnyColumnsTest, GroupByType)
+{
+  voc::AnyColumns columns;
+  columns.registerType<int>();
+  columns.registerType<std::string>();
+  std::vector<voc::Any> any_list;
+  any_list.push_back(42);
+  any_list.push_back(3.14);
+  any_list.push_back(std::string("The cake is a lie!"));
+  any_list.push_back(24);
+  for (auto &any : any_list)
+  {
+    columns.pushBack(std::move(any));
+  }
+  EXPECT_EQ(columns.size(), 4u);
+  ASSERT_NE(columns.getColumn<int>(), nullptr);
+  EXPECT_EQ(*columns.getColumn<int>(), (std::vector<int>{42, 24}));
+  EXPECT_EQ(columns.getColumn<std::string>()->size(), 1u);
+  EXPECT_EQ(columns.getColumn<double>(), nullptr); // not registered, kept in an Any
+}
+
+TEST(AnyColumnsTest, InsertionOrder)
+{
+  voc::AnyColumns columns;
+  columns.pushBack(42);
+  columns.pushBack(voc::Any(3.14));
+  columns.pushBack(std::string("The cake is a lie!"));
+  columns.pushBack(24);
+  EXPECT_EQ(columns.get<int>(0), 42);
+  EXPECT_EQ(columns.get<double>(1), 3.14);
+  EXPECT_EQ(columns.get<std::string>(2), "The cake is a lie!");
+  EXPECT_EQ(columns.get<int>(3), 24);
+  EXPECT_TRUE(columns.holds<double>(1));
+  EXPECT_EQ(columns.getTypeId(2), voc::typeId<std::string>());
+  EXPECT_THROW(columns.get<int>(1), std::bad_cast);
+  EXPECT_THROW(columns.get<double>(0), std::bad_cast);
+}
+
+TEST(AnyColumnsTest, ForEachOfType)
+{
+  voc::AnyColumns columns;
+  columns.registerType<int>();
+  for (int i = 0; i < 10; ++i)
+  {
+    columns.pushBack(voc::Any(i));
+    columns.pushBack(voc::Any(static_cast<double>(i)));
+  }
+  int sum = 0;
+  columns.forEachOfType<int>([&](int &value) { sum += value; });
+  EXPECT_EQ(sum, 45);
+  double total = 0;
+  const voc::AnyColumns &const_columns = columns;
+  const_columns.forEachOfType<double>([&](const double &value) { total += value; });
+  EXPECT_EQ(total, 45.0);
+}
+
+TEST(AnyColumnsTest, CopyMoveAndClear)
+{
+  voc::AnyColumns columns;
+  columns.pushBack(42);
+  columns.pushBack(voc::Any(3.14));
+  voc::AnyColumns copy(columns);
+  voc::AnyColumns moved(std::move(columns));
+  EXPECT_EQ(copy.get<int>(0), 42);
+  EXPECT_EQ(moved.get<double>(1), 3.14);
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_NE(moved.getColumn<int>(), nullptr); // the registered types are kept
+  columns = copy;
+  EXPECT_EQ(columns.size(), 2u);
+}
+
+TEST(AnyColumnsTest, CvQualifiedTypes)
+{
+  voc::AnyColumns columns;
+  columns.registerType<const int>();
+  columns.pushBack(42);
+  ASSERT_NE(columns.getColumn<const int>(), nullptr);
+  EXPECT_EQ(columns.getColumn<const int>(), columns.getColumn<int>());
+  EXPECT_TRUE(columns.holds<const int>(0));
+  EXPECT_EQ(columns.get<const int>(0), 42);
+  int sum = 0;
+  columns.forEachOfType<const int>([&](const int &value) { sum += value; });
+  EXPECT_EQ(sum, 42);
+}
+
+TEST(AnyColumnsTest, BoolValues)
+{
+  voc::AnyColumns columns;
+  columns.pushBack(true);
+  columns.pushBack(1);
+  const bool flag = false;
+  columns.pushBack(flag);
+  columns.pushBack(voc::Any(true));
+  ASSERT_EQ(columns.size(), 4u);
+  EXPECT_TRUE(columns.holds<bool>(0));
+  EXPECT_TRUE(columns.holds<const bool>(2));
+  const bool &first = columns.get<bool>(0); // a reference to the stored bool, not to a proxy
+  EXPECT_TRUE(first);
+  EXPECT_FALSE(columns.get<bool>(2));
+  EXPECT_THROW(columns.get<bool>(1), std::bad_cast);
+  int count = 0;
+  columns.forEachOfType<bool>([&](bool &value) {
+    value = !value;
+    ++count;
+  });
+  EXPECT_EQ(count, 3);
+  EXPECT_FALSE(columns.get<bool>(0));
+  EXPECT_TRUE(columns.get<bool>(2));
+  const voc::AnyColumns &view = columns;
+  count = 0;
+  view.forEachOfType<bool>([&](const bool &value) { count += value; });
+  EXPECT_EQ(count, 1);
+}
+
+namespace
+{
+  /// @brief Add one event of each type to the columns
+  template <int... N>
+  void pushEvents(voc::AnyColumns &columns, std::integer_sequence<int, N...>)
+  {
+    (columns.pushBack(Event<N>{N}), ...);
+  }
+}
+
+TEST(AnyColumnsTest, ManyTypes)
+{
+  voc::AnyColumns columns;
+  pushEvents(columns, std::make_integer_sequence<int, 10>()); // a column is added for each type
+  ASSERT_EQ(columns.size(), 10u);
+  EXPECT_EQ(columns.get<Event<0>>(0).value, 0);
+  EXPECT_EQ(columns.get<Event<9>>(9).value, 9);
+  ASSERT_NE(columns.getColumn<Event<5>>(), nullptr);
+  EXPECT_EQ(columns.getColumn<Event<5>>()->size(), 1u);
+}
+
+#endif // VOC_ANY_COLUMNS_TEST
+
+#if VOC_SHARED_ANY_TEST
+/******************************
+ * TESTS FOR SHAREDANY CLASS  *
+ ******************************/
+
+TEST(SharedAnyTest, CopiesShareTheValue)
+{
+  voc::SharedAny shared = voc::makeSharedAny<std::vector<int>>(1000, 42);
+  std::vector<voc::SharedAny> copies;
+  copies.reserve(16);
+  std::size_t allocations = countAllocations([&]() {
+    for (int i = 0; i < 16; ++i)
+    {
+      copies.push_back(shared);
+    }
+  });
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_EQ(shared.useCount(), 17u);
+  EXPECT_EQ(copies.back().contentPtr(), shared.contentPtr());
+  EXPECT_EQ(voc::anyCast<const std::vector<int> &>(copies.back()).size(), 1000u);
+  copies.clear();
+  EXPECT_TRUE(shared.isUnique());
+}
+
+TEST(SharedAnyTest, CopyOnWrite)
+{
+  voc::SharedAny shared = std::string("The cake is a lie!");
+  voc::SharedAny copy = shared;
+  const void *content = shared.contentPtr();
+
+  // reading does not clone, even through a non-const object
+  EXPECT_EQ(voc::anyCast<const std::string &>(copy), "The cake is a lie!");
+  EXPECT_EQ(voc::anyCast<std::string>(copy), "The cake is a lie!");
+  EXPECT_EQ(copy.contentPtr(), content);
+
+  // writing clones the shared value
+  voc::anyCast<std::string &>(copy) += " Or is it?";
+  EXPECT_NE(copy.contentPtr(), content);
+  EXPECT_EQ(voc::anyCast<const std::string &>(shared), "The cake is a lie!");
+  EXPECT_EQ(voc::anyCast<const std::string &>(copy), "The cake is a lie! Or is it?");
+  EXPECT_TRUE(shared.isUnique());
+  EXPECT_TRUE(copy.isUnique());
+
+  // a unique value is modified in place
+  *voc::anyCast<std::string>(&shared) = "Still alive";
+  EXPECT_EQ(shared.contentPtr(), content);
+}
+
+TEST(SharedAnyTest, Cast)
+{
+  voc::SharedAny shared = 42;
+  const voc::SharedAny &const_shared = shared;
+  EXPECT_TRUE(shared.holds<int>());
+  EXPECT_EQ(shared.getTypeId(), voc::typeId<int>());
+  EXPECT_EQ(*voc::anyCast<int>(&const_shared), 42);
+  EXPECT_EQ(voc::anyCast<double>(&const_shared), nullptr);
+  EXPECT_EQ(voc::anyCast<double>(&shared), nullptr);
+  EXPECT_THROW(voc::anyCast<double>(shared), std::bad_cast);
+  EXPECT_THROW(voc::anyCast<double>(voc::SharedAny(42)), std::bad_cast);
+  EXPECT_EQ(voc::anyCast<int>(std::move(shared)), 42);
+
+  voc::SharedAny empty;
+  EXPECT_FALSE(empty.hasValue());
+  EXPECT_EQ(empty.useCount(), 0u);
+  EXPECT_EQ(empty.getTypeId(), voc::typeId<void>());
+  EXPECT_EQ(voc::anyCast<int>(&empty), nullptr);
+}
+
+TEST(SharedAnyTest, MoveOut)
+{
+  Tracked::reset();
+  voc::SharedAny shared = voc::makeSharedAny<Tracked>(1, 2);
+  voc::SharedAny copy = shared;
+  Tracked shared_value = voc::anyCast<Tracked>(std::move(copy)); // shared, copied
+  EXPECT_EQ(Tracked::copies, 1);
+  copy.clear();
+  Tracked unique_value = voc::anyCast<Tracked>(std::move(shared)); // unique, moved
+  EXPECT_EQ(Tracked::copies, 1);
+  EXPECT_EQ(unique_value.x, 1);
+  EXPECT_EQ(shared_value.y, 2);
+}
+
+TEST(SharedAnyTest, ConversionWithAny)
+{
+  Tracked::reset();
+  voc::Any any(voc::InPlaceType<Tracked>, 1, 2);
+  voc::SharedAny shared(std::move(any)); // moved, the value is not copied
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_TRUE(shared.holds<Tracked>());
+
+  voc::SharedAny copy = shared;
+  voc::Any from_shared(copy); // shared, the value is copied
+  EXPECT_EQ(Tracked::copies, 1);
+  EXPECT_EQ(copy.useCount(), 2u);
+
+  copy.clear();
+  voc::Any from_unique(std::move(shared)); // unique, the value is moved
+  EXPECT_EQ(Tracked::copies, 1);
+  EXPECT_FALSE(shared.hasValue());
+  EXPECT_EQ(voc::anyCast<const Tracked &>(from_unique).x, 1);
+
+  static_assert(!std::is_convertible<voc::Any, voc::SharedAny>::value, "the conversion from Any is explicit");
+  static_assert(!std::is_convertible<voc::SharedAny, voc::Any>::value, "the conversion to Any is explicit");
+  static_assert(!std::is_convertible<voc::SharedAny, bool>::value, "the conversion to bool is explicit");
+  EXPECT_TRUE(static_cast<bool>(from_unique));
+  EXPECT_FALSE(static_cast<bool>(shared));
+}
+
+TEST(SharedAnyTest, Emplace)
+{
+  voc::SharedAny shared = 42;
+  voc::SharedAny copy = shared;
+  std::string &value = copy.emplace<std::string>("The cake is a lie!");
+  value += " Or is it?";
+  EXPECT_EQ(voc::anyCast<const std::string &>(copy), "The cake is a lie! Or is it?");
+  EXPECT_EQ(voc::anyCast<int>(shared), 42);
+  EXPECT_TRUE(shared.isUnique());
+}
+
+TEST(SharedAnyTest, ConcurrentCopies)
+{
+  voc::SharedAny shared = std::string("The cake is a lie!");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([shared]() {
+      for (int j = 0; j < 1000; ++j)
+      {
+        voc::SharedAny copy = shared;
+        EXPECT_EQ(voc::anyCast<const std::string &>(copy).size(), 18u);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_TRUE(shared.isUnique());
+}
+
+#endif // VOC_SHARED_ANY_TEST
+
+#if VOC_VARIANT_TEST
+/******************************
+ * TESTS FOR VARIANT CLASS    *
+ ******************************/
+
+/*
+Variant constructor test suite
+*/
+TEST(VariantConstructorTest, Constructor)
+{
+  voc::Variant<int, double, std::string> variant(42);
+  EXPECT_EQ(variant.index(), 0u);
+  EXPECT_EQ(variant.get<int>(), 42);
+}
+
+TEST(VariantConstructorTest, DefaultConstructor)
+{
+  voc::Variant<std::string, int> variant;
+  EXPECT_TRUE(variant.holds<std::string>());
+  EXPECT_TRUE(variant.get<std::string>().empty());
+}
+
+TEST(VariantConstructorTest, CopyConstructor)
+{
+  voc::Variant<int, std::string> a(std::string("The cake is a lie!"));
+  voc::Variant<int, std::string> b(a);
+  EXPECT_EQ(b.get<std::string>(), "The cake is a lie!");
+  EXPECT_EQ(a.get<std::string>(), "The cake is a lie!");
+}
+
+TEST(VariantConstructorTest, MoveConstructor)
+{
+  Tracked::reset();
+  voc::Variant<int, Tracked> a(voc::InPlaceType<Tracked>, 42, 24);
+  voc::Variant<int, Tracked> b(std::move(a));
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 1);
+  EXPECT_EQ(b.get<Tracked>().y, 24);
+}
+
+/*
+Variant test suite
+*/
+TEST(VariantTest, Assignment)
+{
+  voc::Variant<int, double, std::string> variant;
+  variant = 3.14;
+  EXPECT_EQ(variant.index(), 1u);
+  variant = std::string("The cake is a lie!");
+  EXPECT_EQ(variant.index(), 2u);
+  variant = std::string("short");
+  EXPECT_EQ(variant.get<std::string>(), "short");
+  voc::Variant<int, double, std::string> other(42);
+  variant = other;
+  EXPECT_EQ(variant.get<int>(), 42);
+  other = std::string("The cake is a lie!");
+  variant = std::move(other);
+  EXPECT_EQ(variant.get<std::string>(), "The cake is a lie!");
+}
+
+TEST(VariantTest, GetAndGetIf)
+{
+  voc::Variant<int, std::string> variant(std::string("The cake"));
+  EXPECT_THROW(variant.get<int>(), std::bad_cast);
+  EXPECT_EQ(variant.getIf<int>(), nullptr);
+  std::string *text = variant.getIf<std::string>();
+  ASSERT_NE(text, nullptr);
+  *text += " is a lie!";
+  const auto &const_variant = variant;
+  EXPECT_EQ(const_variant.get<std::string>(), "The cake is a lie!");
+  EXPECT_EQ(const_variant.getIf<std::string>(), text);
+  std::string moved = std::move(variant).get<std::string>();
+  EXPECT_EQ(moved, "The cake is a lie!");
+}
+
+TEST(VariantTest, Emplace)
+{
+  voc::Variant<int, Tracked, std::string> variant(3);
+  Tracked::reset();
+  Tracked &tracked = variant.emplace<Tracked>(42, 24);
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(&tracked, variant.getIf<Tracked>());
+  std::string &text = variant.emplace<std::string>(100, 'x');
+  EXPECT_EQ(variant.get<std::string>(), text);
+}
+
+TEST(VariantTest, ValuelessAfterThrow)
+{
+  struct Throwing
+  {
+    Throwing() { throw std::runtime_error("constructor"); }
+  };
+  voc::Variant<std::string, Throwing> variant(std::string("The cake is a lie!"));
+  EXPECT_THROW(variant.emplace<Throwing>(), std::runtime_error);
+  EXPECT_TRUE(variant.isValueless());
+  EXPECT_EQ(variant.index(), variant.npos);
+  EXPECT_EQ(variant.getTypeId(), voc::typeId<void>());
+  EXPECT_THROW(voc::visit(variant, [](auto &) {}), std::bad_cast);
+  voc::Variant<std::string, Throwing> copy(variant);
+  EXPECT_TRUE(copy.isValueless());
+  variant = std::string("again");
+  EXPECT_EQ(variant.get<std::string>(), "again");
+}
+
+TEST(VariantTest, Swap)
+{
+  voc::Variant<int, std::string> a(42);
+  voc::Variant<int, std::string> b(std::string("The cake is a lie!"));
+  a.swap(b);
+  EXPECT_EQ(a.get<std::string>(), "The cake is a lie!");
+  EXPECT_EQ(b.get<int>(), 42);
+}
+
+TEST(VariantTest, MoveOnly)
+{
+  static_assert(!std::is_copy_constructible<voc::Variant<int, std::unique_ptr<int>>>::value, "Variant of move-only types must not be copyable");
+  static_assert(std::is_nothrow_move_constructible<voc::Variant<int, std::unique_ptr<int>>>::value, "Variant must be nothrow movable");
+  voc::Variant<int, std::unique_ptr<int>> a(std::make_unique<int>(42));
+  voc::Variant<int, std::unique_ptr<int>> b(std::move(a));
+  EXPECT_EQ(*b.get<std::unique_ptr<int>>(), 42);
+}
+
+/*
+Variant storage test suite
+*/
+static_assert(std::is_trivially_copyable<voc::Variant<int, double, char>>::value, "Variant of trivial types must be trivially copyable");
+static_assert(std::is_trivially_destructible<voc::Variant<int, double, char>>::value, "Variant of trivial types must be trivially destructible");
+static_assert(!std::is_trivially_copyable<voc::Variant<int, std::string>>::value, "Variant of std::string must not be trivially copyable");
+static_assert(sizeof(voc::Variant<std::uint32_t, float>) == 8, "Variant must use a one byte index");
+static_assert(sizeof(voc::Variant<char, std::uint8_t>) == 2, "Variant must use a one byte index");
+static_assert(alignof(voc::Variant<char, double>) == alignof(double), "Variant must be aligned for its alternatives");
+
+TEST(VariantStorageTest, NoAllocation)
+{
+  std::size_t allocations = countAllocations([] {
+    voc::Variant<int, double, std::array<double, 8>> variant(std::array<double, 8>{});
+    voc::Variant<int, double, std::array<double, 8>> copy(variant);
+    copy = 42;
+    EXPECT_EQ(copy.get<int>(), 42);
+  });
+  EXPECT_EQ(allocations, 0u);
+}
+
+TEST(VariantStorageTest, LargeIndex)
+{
+  using Large = voc::Variant<Event<0>, Event<1>, Event<2>, Event<3>, Event<4>, Event<5>, Event<6>, Event<7>, Event<8>, Event<9>,
+                             Event<10>, Event<11>, Event<12>, Event<13>, Event<14>, Event<15>, Event<16>, Event<17>, Event<18>, Event<19>>;
+  Large variant(Event<17>{17});
+  EXPECT_EQ(variant.index(), 17u);
+  EXPECT_EQ(voc::visit(variant, [](auto &event) { return event.value; }), 17);
+}
+
+/*
+Variant visit test suite
+*/
+TEST(VariantVisitTest, Visit)
+{
+  std::vector<voc::Variant<int, double, std::string>> list = {42, 3.14, std::string("The cake is a lie!")};
+  std::string result;
+  for (auto &variant : list)
+  {
+    voc::visit(variant, Overloaded{
+                            [&](int &value) { result += "int:" + std::to_string(value) + " "; },
+                            [&](double &) { result += "double "; },
+                            [&](std::string &value) { result += "string:" + value; },
+                        });
+  }
+  EXPECT_EQ(result, "int:42 double string:The cake is a lie!");
+}
+
+TEST(VariantVisitTest, ByReference)
+{
+  voc::Variant<int, std::string> variant(std::string("The cake"));
+  voc::visit(variant, Overloaded{
+                          [](int &) {},
+                          [](std::string &value) { value += " is a lie!"; },
+                      });
+  const auto &const_variant = variant;
+  std::size_t size = voc::visit(const_variant, Overloaded{
+                                                   [](const int &) -> std::size_t { return 0; },
+                                                   [](const std::string &value) -> std::size_t { return value.size(); },
+                                               });
+  EXPECT_EQ(size, 18u);
+}
+
+/*
+Variant conversion test suite
+*/
+TEST(VariantConversionTest, ToAny)
+{
+  voc::Variant<int, std::string> variant(std::string("The cake is a lie!"));
+  voc::Any copy = static_cast<voc::Any>(variant);
+  EXPECT_EQ(voc::anyCast<const std::string &>(copy), "The cake is a lie!");
+  EXPECT_EQ(variant.get<std::string>(), "The cake is a lie!");
+  voc::Any moved = static_cast<voc::Any>(std::move(variant));
+  EXPECT_EQ(voc::anyCast<const std::string &>(moved), "The cake is a lie!");
+  EXPECT_EQ(variant.getTypeId(), voc::typeId<std::string>());
+}
+
+#endif // VOC_VARIANT_TEST
+
+#if VOC_ATOMIC_OPTIONAL_TEST
+/************************************
+ * TESTS FOR ATOMICOPTIONAL CLASS   *
+ ************************************/
+
+namespace
+{
+  /// @brief Value too large for a lock-free word, its fields are always equal
+  struct Quote
+  {
+    std::uint64_t bid;
+    std::uint64_t ask;
+    std::uint64_t size;
+    std::uint64_t time;
+  };
+
+  /// @brief Build a Quote whose fields are all equal
+  Quote makeQuote(std::uint64_t value)
+  {
+    return Quote{value, value, value, value};
+  }
+
+  /// @brief Check that the fields of a Quote were written by the same store
+  bool isConsistent(const Quote &quote)
+  {
+    return quote.bid == quote.ask && quote.ask == quote.size && quote.size == quote.time;
+  }
+}
+
+static_assert(voc::AtomicOptional<int>::isAlwaysLockFree, "int and its flag fit in 8 bytes");
+static_assert(voc::AtomicOptional<std::uint16_t>::isAlwaysLockFree, "std::uint16_t and its flag fit in 8 bytes");
+static_assert(!voc::AtomicOptional<Quote>::isAlwaysLockFree, "Quote uses the sequence lock");
+#if defined(__x86_64__)
+static_assert(voc::AtomicOptional<double>::isAlwaysLockFree, "double and its flag use the 16 bytes compare and swap, build with -mcx16");
+static_assert(voc::AtomicOptional<std::int64_t>::isAlwaysLockFree, "std::int64_t and its flag use the 16 bytes compare and swap, build with -mcx16");
+#endif
+
+/*
+AtomicOptional test suite
+*/
+template <typename T>
+class AtomicOptionalTest : public ::testing::Test
+{
+};
+
+using AtomicOptionalTypes = ::testing::Types<int, double, Quote>;
+TYPED_TEST_SUITE(AtomicOptionalTest, AtomicOptionalTypes);
+
+namespace
+{
+  /// @brief Build a test value of type T
+  template <typename T>
+  T makeAtomicValue(int value)
+  {
+    if constexpr (std::is_same<T, Quote>::value)
+    {
+      return makeQuote(value);
+    }
+    else
+    {
+      return static_cast<T>(value);
+    }
+  }
+
+  /// @brief Get the test value stored in a value of type T
+  template <typename T>
+  int atomicValueOf(const T &value)
+  {
+    if constexpr (std::is_same<T, Quote>::value)
+    {
+      return static_cast<int>(value.bid);
+    }
+    else
+    {
+      return static_cast<int>(value);
+    }
+  }
+}
+
+TYPED_TEST(AtomicOptionalTest, StoreAndLoad)
+{
+  voc::AtomicOptional<TypeParam> atomic;
+  EXPECT_FALSE(atomic.load().hasValue());
+  atomic.store(makeAtomicValue<TypeParam>(42));
+  voc::Optional<TypeParam> value = atomic.load();
+  ASSERT_TRUE(value.hasValue());
+  EXPECT_EQ(atomicValueOf(*value), 42);
+  atomic.clear();
+  EXPECT_FALSE(atomic.load().hasValue());
+}
+
+TYPED_TEST(AtomicOptionalTest, ExchangeAndTake)
+{
+  voc::AtomicOptional<TypeParam> atomic(makeAtomicValue<TypeParam>(1));
+  voc::Optional<TypeParam> previous = atomic.exchange(makeAtomicValue<TypeParam>(2));
+  EXPECT_EQ(atomicValueOf(*previous), 1);
+  voc::Optional<TypeParam> taken = atomic.take();
+  EXPECT_EQ(atomicValueOf(*taken), 2);
+  EXPECT_FALSE(atomic.take().hasValue());
+  EXPECT_FALSE(atomic.load().hasValue());
+}
+
+TYPED_TEST(AtomicOptionalTest, CompareExchange)
+{
+  voc::AtomicOptional<TypeParam> atomic;
+  voc::Optional<TypeParam> expected;
+  EXPECT_TRUE(atomic.compareExchange(expected, makeAtomicValue<TypeParam>(1)));
+  expected = makeAtomicValue<TypeParam>(5);
+  EXPECT_FALSE(atomic.compareExchange(expected, makeAtomicValue<TypeParam>(2)));
+  ASSERT_TRUE(expected.hasValue());
+  EXPECT_EQ(atomicValueOf(*expected), 1); // the current value
+  EXPECT_TRUE(atomic.compareExchange(expected, voc::Optional<TypeParam>()));
+  EXPECT_FALSE(atomic.load().hasValue());
+}
+
+TYPED_TEST(AtomicOptionalTest, ConcurrentIncrements)
+{
+  constexpr int Threads = 4;
+  constexpr int Increments = 2000;
+  voc::AtomicOptional<TypeParam> atomic(makeAtomicValue<TypeParam>(0));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < Threads; ++t)
+  {
+    threads.emplace_back([&] {
+      for (int i = 0; i < Increments; ++i)
+      {
+        voc::Optional<TypeParam> expected = atomic.load();
+        while (!atomic.compareExchange(expected, makeAtomicValue<TypeParam>(atomicValueOf(*expected) + 1)))
+        {
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(atomicValueOf(*atomic.load()), Threads * Increments);
+}
+
+TEST(AtomicOptionalStressTest, NoTornReads)
+{
+  voc::AtomicOptional<Quote> atomic;
+  std::atomic<bool> stop{false};
+  std::atomic<int> torn{0};
+  std::vector<std::thread> threads;
+  for (int w = 0; w < 2; ++w)
+  {
+    threads.emplace_back([&, w] {
+      for (std::uint64_t i = 1; i <= 20000; ++i)
+      {
+        if (i % 7 == 0)
+        {
+          atomic.clear();
+        }
+        else
+        {
+          atomic.store(makeQuote(i * 2 + w));
+        }
+      }
+    });
+  }
+  for (int r = 0; r < 2; ++r)
+  {
+    threads.emplace_back([&] {
+      while (!stop.load())
+      {
+        voc::Optional<Quote> quote = atomic.load();
+        if (quote.hasValue() && !isConsistent(*quote))
+        {
+          ++torn;
+        }
+      }
+    });
+  }
+  threads[0].join();
+  threads[1].join();
+  stop = true;
+  threads[2].join();
+  threads[3].join();
+  EXPECT_EQ(torn.load(), 0);
+}
+
+TEST(AtomicOptionalStressTest, TakeDeliversEachValueOnce)
+{
+  constexpr int Values = 5000;
+  voc::AtomicOptional<int> slot;
+  std::atomic<bool> done{false};
+  std::atomic<long long> takenSum{0};
+  std::thread producer([&] {
+    for (int i = 1; i <= Values; ++i)
+    {
+      voc::Optional<int> expected;
+      while (!slot.compareExchange(expected, i)) // wait for the consumers to take the previous value
+      {
+        expected = voc::Optional<int>();
+        std::this_thread::yield();
+      }
+    }
+    done = true;
+  });
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < 3; ++c)
+  {
+    consumers.emplace_back([&] {
+      while (!done.load() || slot.load().hasValue())
+      {
+        if (voc::Optional<int> value = slot.take())
+        {
+          takenSum += *value;
+        }
+        else
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  producer.join();
+  for (std::thread &consumer : consumers)
+  {
+    consumer.join();
+  }
+  EXPECT_EQ(takenSum.load(), static_cast<long long>(Values) * (Values + 1) / 2);
+}
+
+#endif // VOC_ATOMIC_OPTIONAL_TEST
+
+#if VOC_ATOMIC_ANY_TEST
+/*******************************
+ * TESTS FOR ATOMICANY CLASS   *
+ *******************************/
+
+namespace
+{
+  /// @brief Configuration whose entries all equal its version, counting the live objects
+  struct Settings
+  {
+    static inline std::atomic<int> live{0}; ///< Number of objects not destroyed yet
+
+    explicit Settings(int version) : version(version), entries(16, version) { ++live; }
+    Settings(const Settings &other) : version(other.version), entries(other.entries) { ++live; }
+    ~Settings() { --live; }
+
+    /// @brief Check that the entries were not modified or destroyed
+    bool isConsistent() const
+    {
+      return std::all_of(entries.begin(), entries.end(), [this](int entry) { return entry == version; });
+    }
+
+    int version;
+    std::vector<int> entries;
+  };
+}
+
+/*
+AtomicAny test suite
+*/
+TEST(AtomicAnyTest, DefaultIsEmpty)
+{
+  voc::AtomicAny slot;
+  voc::AtomicAny::Snapshot snapshot = slot.read();
+  EXPECT_FALSE(snapshot);
+  EXPECT_FALSE(snapshot->hasValue());
+  EXPECT_FALSE(slot.load());
+}
+
+TEST(AtomicAnyTest, StoreAndRead)
+{
+  voc::AtomicAny slot(voc::Any(42));
+  {
+    voc::AtomicAny::Snapshot snapshot = slot.read();
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(voc::anyCast<int>(*snapshot), 42);
+  }
+  slot.emplace<std::string>("config");
+  EXPECT_EQ(voc::anyCast<const std::string &>(*slot.read()), "config");
+  slot.clear();
+  EXPECT_FALSE(slot.read());
+}
+
+TEST(AtomicAnyTest, SnapshotMove)
+{
+  voc::AtomicAny slot(voc::Any(1));
+  voc::AtomicAny::Snapshot first = slot.read();
+  voc::AtomicAny::Snapshot second = std::move(first);
+  EXPECT_FALSE(first);
+  EXPECT_EQ(voc::anyCast<int>(*second), 1);
+  second.reset();
+  EXPECT_FALSE(second);
+  slot.store(voc::Any(2)); // does not wait, every snapshot is released
+  EXPECT_EQ(voc::anyCast<int>(*slot.read()), 2);
+}
+
+TEST(AtomicAnyTest, LoadOutlivesStore)
+{
+  voc::AtomicAny slot(voc::Any(1));
+  voc::SharedAny kept = slot.load();
+  EXPECT_EQ(kept.useCount(), 2u);
+  slot.store(voc::Any(2));
+  EXPECT_EQ(kept.useCount(), 1u);
+  EXPECT_EQ(voc::anyCast<int>(kept), 1);
+  EXPECT_EQ(voc::anyCast<int>(*slot.read()), 2);
+}
+
+TEST(AtomicAnyTest, ExchangeReturnsPrevious)
+{
+  voc::AtomicAny slot;
+  EXPECT_FALSE(slot.exchange(voc::SharedAny(1)));
+  voc::SharedAny previous = slot.exchange(voc::SharedAny(2));
+  EXPECT_TRUE(previous.isUnique());
+  EXPECT_EQ(voc::anyCast<int>(previous), 1);
+}
+
+TEST(AtomicAnyTest, StoreWaitsForSnapshots)
+{
+  {
+    voc::AtomicAny slot;
+    slot.emplace<Settings>(1);
+    std::atomic<bool> stored{false};
+    voc::AtomicAny::Snapshot snapshot = slot.read();
+    std::thread writer([&] {
+      slot.emplace<Settings>(2);
+      stored = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(stored.load());
+    EXPECT_EQ(voc::anyCast<const Settings &>(*snapshot).version, 1);
+    EXPECT_TRUE(voc::anyCast<const Settings &>(*snapshot).isConsistent());
+    snapshot.reset();
+    writer.join();
+    EXPECT_TRUE(stored.load());
+    EXPECT_EQ(Settings::live.load(), 1);
+  }
+  EXPECT_EQ(Settings::live.load(), 0);
+}
+
+TEST(AtomicAnyStressTest, ReadersSeeConsistentValues)
+{
+  constexpr int Versions = 500;
+  {
+    voc::AtomicAny slot;
+    slot.emplace<Settings>(0);
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+    {
+      readers.emplace_back([&] {
+        int last = 0;
+        while (!done.load())
+        {
+          voc::AtomicAny::Snapshot snapshot = slot.read();
+          const Settings *settings = voc::anyCast<Settings>(&*snapshot);
+          if (!settings || !settings->isConsistent() || settings->version < last)
+          {
+            ++errors;
+          }
+          else
+          {
+            last = settings->version;
+          }
+          const voc::SharedAny kept = slot.load(); // the shared value stays valid after the snapshot
+          snapshot.reset();
+          if (!voc::anyCast<Settings>(&kept)->isConsistent())
+          {
+            ++errors;
+          }
+        }
+      });
+    }
+    std::thread writer([&] {
+      for (int version = 1; version <= Versions; ++version)
+      {
+        slot.emplace<Settings>(version);
+      }
+      done = true;
+    });
+    writer.join();
+    for (std::thread &reader : readers)
+    {
+      reader.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_EQ(voc::anyCast<const Settings &>(*slot.read()).version, Versions);
+    EXPECT_EQ(Settings::live.load(), 1);
+  }
+  EXPECT_EQ(Settings::live.load(), 0);
+}
+
+#endif // VOC_ATOMIC_ANY_TEST
+
+#if VOC_ANY_QUEUE_TEST
+/*****************************
+ * TESTS FOR ANYQUEUE CLASS  *
+ *****************************/
+
+namespace
+{
+  /// @brief Message too large to be stored inline
+  struct LargeMessage
+  {
+    int producer;
+    int sequence;
+    char padding[64];
+  };
+}
+
+/*
+AnyQueue test suite
+*/
+TEST(AnyQueueTest, CapacityIsRoundedUp)
+{
+  EXPECT_EQ(voc::AnyQueue(0).capacity(), 2u);
+  EXPECT_EQ(voc::AnyQueue(5).capacity(), 8u);
+  EXPECT_EQ(voc::AnyQueue(16).capacity(), 16u);
+}
+
+TEST(AnyQueueTest, TryPushAndTryPop)
+{
+  voc::AnyQueue queue(4);
+  voc::UniqueAny value;
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_TRUE(queue.tryPush(voc::UniqueAny(1)));
+  EXPECT_TRUE(queue.tryPush(voc::Any(std::string("two"))));
+  EXPECT_TRUE(queue.tryEmplace<LargeMessage>(LargeMessage{3, 3, {}}));
+  EXPECT_EQ(queue.approximateSize(), 3u);
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(voc::anyCast<int>(value), 1);
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(voc::anyCast<const std::string &>(value), "two");
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(voc::anyCast<const LargeMessage &>(value).sequence, 3);
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_EQ(queue.approximateSize(), 0u);
+}
+
+TEST(AnyQueueTest, TryPushFailsWhenFull)
+{
+  voc::AnyQueue queue(2);
+  EXPECT_TRUE(queue.tryEmplace<int>(1));
+  EXPECT_TRUE(queue.tryEmplace<int>(2));
+  voc::UniqueAny third(3);
+  EXPECT_FALSE(queue.tryPush(std::move(third)));
+  EXPECT_EQ(voc::anyCast<int>(third), 3); // not moved from
+  voc::UniqueAny value;
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_TRUE(queue.tryPush(std::move(third)));
+}
+
+TEST(AnyQueueTest, MoveOnlyValues)
+{
+  voc::AnyQueue queue(4);
+  EXPECT_TRUE(queue.tryEmplace<std::unique_ptr<int>>(std::make_unique<int>(42)));
+  voc::UniqueAny value = queue.pop();
+  EXPECT_EQ(*voc::anyCast<const std::unique_ptr<int> &>(value), 42);
+}
+
+TEST(AnyQueueTest, InlineValuesDoNotAllocate)
+{
+  voc::AnyQueue queue(8);
+  voc::UniqueAny value;
+  std::size_t allocations = countAllocations([&] {
+    for (int i = 0; i < 100; ++i)
+    {
+      queue.tryEmplace<int>(i);
+      queue.tryPop(value);
+    }
+  });
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_EQ(voc::anyCast<int>(value), 99);
+}
+
+TEST(AnyQueueTest, BatchOperations)
+{
+  voc::AnyQueue queue(4);
+  std::vector<voc::UniqueAny> values;
+  for (int i = 0; i < 6; ++i)
+  {
+    values.emplace_back(i);
+  }
+  EXPECT_EQ(queue.tryPushN(values.data(), values.size()), 4u);
+  EXPECT_FALSE(values[3].hasValue());
+  EXPECT_TRUE(values[4].hasValue());
+  std::vector<voc::UniqueAny> popped(3);
+  EXPECT_EQ(queue.tryPopN(popped.data(), popped.size()), 3u);
+  EXPECT_EQ(queue.tryPushN(values.data() + 4, 2), 2u);
+  EXPECT_EQ(queue.tryPopN(popped.data(), popped.size()), 3u);
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(voc::anyCast<int>(popped[i]), i + 3);
+  }
+  EXPECT_EQ(queue.tryPopN(popped.data(), popped.size()), 0u);
+  EXPECT_EQ(queue.popN(popped.data(), 0), 0u); // returns without waiting, even if the queue is empty
+  EXPECT_EQ(queue.tryPushN(values.data(), 0), 0u);
+  queue.pushN(values.data(), 0);
+  EXPECT_EQ(queue.approximateSize(), 0u);
+}
+
+TEST(AnyQueueTest, BlockingPushWaitsForConsumer)
+{
+  voc::AnyQueue queue(2);
+  queue.emplace<int>(1);
+  queue.emplace<int>(2);
+  std::atomic<bool> pushed{false};
+  std::thread producer([&] {
+    queue.emplace<int>(3);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(pushed.load());
+  EXPECT_EQ(voc::anyCast<int>(queue.pop()), 1);
+  producer.join();
+  EXPECT_TRUE(pushed.load());
+  std::vector<voc::UniqueAny> popped(4);
+  EXPECT_EQ(queue.popN(popped.data(), popped.size()), 2u);
+  EXPECT_EQ(voc::anyCast<int>(popped[1]), 3);
+}
+
+TEST(AnyQueueStressTest, EachMessageIsDeliveredOnce)
+{
+  constexpr int Producers = 3;
+  constexpr int Consumers = 3;
+  constexpr int Messages = 3000; // by producer
+  voc::AnyQueue queue(16);
+  std::atomic<long long> sum{0};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < Producers; ++p)
+  {
+    threads.emplace_back([&, p] {
+      voc::UniqueAny batch[4];
+      for (int i = 0; i < Messages; i += 4)
+      {
+        for (int j = 0; j < 4; ++j)
+        {
+          if ((i + j) % 2 == 0)
+          {
+            batch[j] = voc::UniqueAny(i + j); // inline
+          }
+          else
+          {
+            batch[j] = voc::makeUniqueAny<LargeMessage>(LargeMessage{p, i + j, {}}); // on the heap
+          }
+        }
+        queue.pushN(batch, 4);
+      }
+    });
+  }
+  for (int c = 0; c < Consumers; ++c)
+  {
+    threads.emplace_back([&, c] {
+      constexpr int Quota = Producers * Messages / Consumers;
+      int received = 0;
+      voc::UniqueAny batch[8];
+      while (received < Quota)
+      {
+        std::size_t count = 1;
+        if (c == 0)
+        {
+          count = queue.popN(batch, std::min(8, Quota - received)); // batches, without taking more than its quota
+        }
+        else
+        {
+          batch[0] = queue.pop();
+        }
+        for (std::size_t k = 0; k < count; ++k)
+        {
+          if (const int *value = voc::anyCast<int>(&batch[k]))
+          {
+            sum += *value;
+          }
+          else if (const LargeMessage *message = voc::anyCast<LargeMessage>(&batch[k]))
+          {
+            sum += message->sequence;
+          }
+          else
+          {
+            ++errors;
+          }
+        }
+        received += static_cast<int>(count);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(sum.load(), static_cast<long long>(Producers) * Messages * (Messages - 1) / 2);
+  voc::UniqueAny value;
+  EXPECT_FALSE(queue.tryPop(value));
+}
+
+#endif // VOC_ANY_QUEUE_TEST
 
 int main(int argc, char *argv[])
 {